@@ -29,13 +29,14 @@ extern "C" {
 #include "main.h"
 
 /* USER CODE BEGIN Includes */
-
+#include "timebase.h"
 /* USER CODE END Includes */
 
 extern ADC_HandleTypeDef hadc2;
 
 /* USER CODE BEGIN Private defines */
-
+#define ADC_FILTER_ALPHA 0.1f // Weight of a new sample in the filtered voltages
+#define ADC_RING_SIZE 16      // Filtered frames kept in the acquisition ring
 /* USER CODE END Private defines */
 
 void MX_ADC2_Init(void);
@@ -61,6 +62,27 @@ uint16_t ADC_ReadChannel(uint32_t channel);
   * @retval Voltage in volts
   */
 float ADC_ConvertToVoltage(uint16_t adcValue);
+
+/**
+  * @brief  Get the low-pass filtered voltage of a channel
+  * @param  channel: Voltage channel (VoltageEnum)
+  * @retval Filtered voltage in volts
+  */
+float ADC_GetFiltered(uint8_t channel);
+
+/**
+  * @brief  Get the time the last ADC_ReadAll frame was sampled
+  * @retval Timebase time of the first conversion of the frame
+  */
+Timestamp_t ADC_GetFrameTime(void);
+
+/**
+  * @brief  Copy the newest filtered frames from the acquisition ring
+  * @param  frames: Array to store the frames in mV, oldest first
+  * @param  count: Frames wanted (max ADC_RING_SIZE)
+  * @retval Frames copied, fewer than count until the ring has filled
+  */
+uint8_t ADC_CopyRecent(uint16_t (*frames)[VOLTAGE_COUNT], uint8_t count);
 /* USER CODE END Prototypes */
 
 #ifdef __cplusplus
@@ -26,6 +26,36 @@ extern "C" {
 #define BATTERY_MIN_VOLTAGE  11.0f  // Minimum battery voltage (0%)
 #define BATTERY_MAX_VOLTAGE  14.4f  // Maximum battery voltage (100%)
 #define BATTERY_LOW_VOLTAGE  11.5f  // Low battery warning threshold
+#define BATTERY_BANK_COUNT   2      // BANK_A and BANK_B
+
+/* Low-voltage alarm thresholds: a level is entered below its set voltage and
+   left above its clear voltage, each only after the qualification time. */
+#define BATTERY_WARNING_SET_VOLTAGE     BATTERY_LOW_VOLTAGE
+#define BATTERY_WARNING_CLEAR_VOLTAGE   11.8f
+#define BATTERY_CRITICAL_SET_VOLTAGE    11.2f
+#define BATTERY_CRITICAL_CLEAR_VOLTAGE  11.6f
+#define BATTERY_CUTOFF_SET_VOLTAGE      10.8f
+#define BATTERY_CUTOFF_CLEAR_VOLTAGE    11.4f
+#define BATTERY_ALARM_SET_TIME          2000 // ms below set voltage before entering a level
+#define BATTERY_ALARM_CLEAR_TIME        5000 // ms above clear voltage before leaving a level
+
+/* Low-voltage disconnect: output opens when a bank reaches the cutoff level and
+   is released once every bank stays above the reconnect voltage for the holdoff.
+   A running holdoff is aborted by a bank back in cutoff, or by a bank staying
+   below the hysteresis band for the abort time; shorter dips only pause it. */
+#define BATTERY_RECONNECT_VOLTAGE       12.4f
+#define BATTERY_RECONNECT_HYSTERESIS    0.2f  // V below the reconnect voltage that counts as a dip
+#define BATTERY_RECONNECT_HOLDOFF       30000 // ms
+#define BATTERY_RECONNECT_ABORT_TIME    1000  // ms below the band before the holdoff is aborted
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  BATTERY_ALARM_NONE = 0,
+  BATTERY_ALARM_WARNING,
+  BATTERY_ALARM_CRITICAL,
+  BATTERY_ALARM_CUTOFF,
+  BATTERY_ALARM_COUNT
+} BatteryAlarmEnum;
 
 /* Exported function prototypes ----------------------------------------------*/
 
@@ -55,6 +85,19 @@ uint8_t BATTERY_CalculateLevel(float voltage);
   */
 uint8_t BATTERY_IsLow(float voltage);
 
+/**
+  * @brief  Get qualified low-voltage alarm level of a bank
+  * @param  bank: BANK_A or BANK_B
+  * @retval Alarm level (BatteryAlarmEnum)
+  */
+uint8_t BATTERY_GetAlarm(uint8_t bank);
+
+/**
+  * @brief  Check if the low-voltage disconnect holds the output open
+  * @retval 1 if disconnected, 0 otherwise
+  */
+uint8_t BATTERY_IsDisconnected(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file    charge_control.h
+  * @brief   Charge termination module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CHARGE_CONTROL_H
+#define __CHARGE_CONTROL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define CHARGER_SLOPE_INTERVAL    60000     // ms between dV/dt evaluations (1 min)
+#define CHARGER_PLATEAU_DV        3.0f      // mV per interval regarded as flat
+#define CHARGER_PLATEAU_INTERVALS 15        // Consecutive flat intervals that end a phase (15 min)
+#define CHARGER_NEGATIVE_DV_ENABLE 1        // Terminate on a drop below the peak bank voltage
+#define CHARGER_NEGATIVE_DV       20.0f     // mV below the peak regarded as -dV
+#define CHARGER_MIN_PHASE_TIME    600000    // ms before plateau or -dV may end a phase (10 min)
+/* Safety limits count the time actually charged in the commanded mode. An
+   inhibit pauses the count and restarts the slope detection, only a change
+   of the commanded mode or a termination restarts the count. */
+#define CHARGER_FAST_TIMEOUT      18000000  // Safety limit of CHARGE_FAST in ms (5 h)
+#define CHARGER_NORMAL_TIMEOUT    36000000  // Safety limit of CHARGE_NORMAL in ms (10 h)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  CHARGER_END_NONE = 0,
+  CHARGER_END_PLATEAU,    // dV/dt stayed flat on every channel
+  CHARGER_END_NEGATIVE_DV,// A bank fell below its peak
+  CHARGER_END_TIMEOUT     // Cumulative charge time safety limit
+} ChargerEndEnum;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize charge termination detection
+  * @retval None
+  */
+void CHARGER_Init(void);
+
+/**
+  * @brief  Evaluate the termination criteria of the running charge phase
+  * @note   Uses the filtered samples, call after ADC_ReadAll
+  * @retval None
+  */
+void CHARGER_Update(void);
+
+/**
+  * @brief  Suspend termination detection, e.g. during an equalization charge
+  * @param  suspend: 1 to suspend, 0 to resume with a new phase
+  * @retval None
+  */
+void CHARGER_Suspend(uint8_t suspend);
+
+/**
+  * @brief  Get the reason the last charge phase was terminated
+  * @retval ChargerEndEnum
+  */
+uint8_t CHARGER_GetLastEnd(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CHARGE_CONTROL_H */
@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file    crash_report.h
+  * @brief   Crash capture and post-mortem report module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CRASH_REPORT_H
+#define __CRASH_REPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * A HardFault or Error_Handler call saves the faulting context into the
+ * .noinit RAM section (STM32F103C8TX_FLASH.ld), drives the outputs off and
+ * resets. The report survives the reset (not power loss) and is journaled
+ * at the next boot; it stays readable until cleared. HardFault_Handler is
+ * defined here, its generation is disabled in FW_ESS.ioc.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define CRASH_MAGIC         0x43524153UL  // 'CRAS', report valid
+#define CRASH_STACK_WORDS   16            // Words dumped above the faulting stack pointer
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  CRASH_SOURCE_NONE = 0,
+  CRASH_SOURCE_HARDFAULT,   // HardFault (bus, memory and usage faults escalate to it)
+  CRASH_SOURCE_ERROR        // Error_Handler called by HAL init code
+} CrashSourceEnum;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t count;           // Crashes since power-on
+  uint8_t source;           // CrashSourceEnum
+  uint8_t pending;          // 1 until reported at boot
+  uint8_t frameValid;       // 0 if the stack pointer was outside RAM (registers not read)
+  uint8_t reserved;
+  uint32_t tick;            // HAL tick at the crash
+  uint32_t r0, r1, r2, r3, r12;
+  uint32_t lr;              // Stacked LR (caller of Error_Handler for CRASH_SOURCE_ERROR)
+  uint32_t pc;              // Faulting instruction (caller of Error_Handler)
+  uint32_t xpsr;
+  uint32_t cfsr;            // SCB->CFSR
+  uint32_t hfsr;            // SCB->HFSR
+  uint32_t bfar;            // SCB->BFAR
+  uint32_t mmfar;           // SCB->MMFAR
+  uint32_t sp;              // Stack pointer before the exception
+  uint32_t stack[CRASH_STACK_WORDS];
+  uint32_t checksum;        // Inverted sum of all words above
+} CrashReport_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Validate the saved report and journal a new crash
+  * @note   EVENT_Init must have been called
+  * @retval None
+  */
+void CRASH_Init(void);
+
+/**
+  * @brief  Get the saved crash report
+  * @retval Pointer to the report, NULL if there is none
+  */
+const CrashReport_t* CRASH_GetReport(void);
+
+/**
+  * @brief  Discard the saved crash report
+  * @retval None
+  */
+void CRASH_Clear(void);
+
+/**
+  * @brief  Save a report for a fatal software error, drive outputs off and reset
+  * @param  caller: Return address of Error_Handler
+  * @retval None (does not return)
+  */
+void CRASH_FromError(uint32_t caller) __attribute__((noreturn));
+
+/**
+  * @brief  HardFault exception entry
+  * @retval None (does not return)
+  */
+void HardFault_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRASH_REPORT_H */
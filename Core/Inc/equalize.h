@@ -0,0 +1,95 @@
+/**
+  ******************************************************************************
+  * @file    equalize.h
+  * @brief   Equalization charge scheduler module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __EQUALIZE_H
+#define __EQUALIZE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define EQUALIZE_INTERVAL        1814400   // Operating seconds between equalizations (21 days)
+#define EQUALIZE_DURATION        7200      // Seconds of equalization charge (2 h)
+#define EQUALIZE_START_VOLTAGE   12.6f     // Every bank must be above this to start
+#define EQUALIZE_MAX_VOLTAGE     15.5f     // Abort when a bank rises above this
+#define EQUALIZE_UPDATE_INTERVAL 1000      // ms between scheduler steps
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  EQUALIZE_IDLE = 0,      // Not due
+  EQUALIZE_PENDING,       // Due or requested, waiting for safe conditions
+  EQUALIZE_RUNNING        // Equalization charge in progress
+} EqualizePhaseEnum;
+
+typedef enum {
+  EQUALIZE_OUTCOME_NONE = 0,
+  EQUALIZE_OUTCOME_COMPLETE,    // Full duration applied
+  EQUALIZE_OUTCOME_FAULT,       // Aborted by a fault
+  EQUALIZE_OUTCOME_NO_CHARGER,  // Aborted, charger lost
+  EQUALIZE_OUTCOME_OVERVOLTAGE, // Aborted, bank above EQUALIZE_MAX_VOLTAGE
+  EQUALIZE_OUTCOME_USER,        // Aborted by command or charge mode change
+  EQUALIZE_OUTCOME_LOW_BANK     // Start held, a bank at or below EQUALIZE_START_VOLTAGE
+} EqualizeOutcomeEnum;
+
+typedef struct {
+  uint32_t lastRunSeconds;  // Operating seconds at the last completed equalization
+  uint16_t cycles;          // Completed equalizations
+  uint8_t lastOutcome;      // EqualizeOutcomeEnum of the last run
+  uint8_t reserved;
+} EqualizeRecord_t;
+
+typedef struct {
+  EqualizeRecord_t record;  // Persisted part
+  uint8_t phase;            // EqualizePhaseEnum
+  uint8_t waiting;          // EqualizeOutcomeEnum holding the pending start, NONE otherwise
+  uint32_t elapsed;         // Seconds into the running equalization, from the HAL tick
+} EqualizeStatus_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the scheduler and restore its record from flash
+  * @note   NVM_Init and LIFETIME_Init must have been called
+  * @retval None
+  */
+void EQUALIZE_Init(void);
+
+/**
+  * @brief  Start a due equalization when safe and supervise a running one
+  * @retval None
+  */
+void EQUALIZE_Update(void);
+
+/**
+  * @brief  Request an equalization now or abort the pending/running one
+  * @param  start: 1 to request, 0 to abort
+  * @retval None
+  */
+void EQUALIZE_Request(uint8_t start);
+
+/**
+  * @brief  Get scheduler status
+  * @retval Pointer to the status
+  */
+const EqualizeStatus_t* EQUALIZE_GetStatus(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EQUALIZE_H */
@@ -0,0 +1,149 @@
+/**
+  ******************************************************************************
+  * @file    event_log.h
+  * @brief   Event log module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __EVENT_LOG_H
+#define __EVENT_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define EVENT_LOG_SIZE 16 // Number of events kept in RAM (oldest overwritten)
+
+/*
+ * Every event is also appended to a flash journal in the NVM_JOURNAL pages.
+ * Records are programmed in steps of EVENT_JOURNAL_STEP half-words from
+ * EVENT_Update, so one call stalls flash fetches for at most a few hundred
+ * microseconds (about 70 us per half-word). The page after the one being
+ * filled is erased ahead as a step of its own; a page erase stalls the CPU
+ * for up to 40 ms and is the longest single step. The pages are filled in
+ * turn, so they wear evenly.
+ */
+#define EVENT_JOURNAL_QUEUE 8  // Records waiting to be programmed
+#define EVENT_JOURNAL_STEP  4  // Half-words programmed per EVENT_Update call
+#define EVENT_JOURNAL_CHUNK 4  // Records per USB chunk
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  EVENT_NONE = 0,
+  EVENT_LOW_VOLTAGE,      // Bank alarm level changed (source = bank, data = new level)
+  EVENT_LVD_DISCONNECT,   // Output opened by low-voltage disconnect (source = bank, data = mV)
+  EVENT_LVD_HOLDOFF,      // Reconnect holdoff started (data = 1) or aborted (data = 0) (source = gating bank)
+  EVENT_LVD_RECONNECT,    // Output released after recovery (source = bank, data = mV)
+  EVENT_STATE_CHANGE,     // System state transition (source = old state, data = new state)
+  EVENT_DRAIN_ALARM,      // Standby drain rate above limit (source = bank, data = 0.1 mV/h)
+  EVENT_CHARGE_TERMINATED,// Charge phase ended (source = ChargerEndEnum, data = ended charge mode)
+  EVENT_EQUALIZE,         // Equalization started (source = 0, data = cycles) or ended (source = outcome, data = s)
+  EVENT_FAULT,            // Fault line latched or cleared (source = fault bit, data = FaultEventEnum)
+  EVENT_RESET,            // MCU started (source = WatchdogResetEnum, data = task that missed its deadline)
+  EVENT_CRASH,            // Crash report saved before the reset (source = CrashSourceEnum, data = PC low half-word)
+  EVENT_POWER_FAIL,       // Emergency record saved on supply drop (source = last fault flags, data = save time in us)
+  EVENT_RELAY,            // Relay actuation retried or failed, or spontaneous change (source = LatchResultEnum, data = position)
+  EVENT_OUTPUT_CHECK,     // Output readback mismatch persisted (source = new failed bits, data = all failed bits)
+  EVENT_PROTECTION        // Protection rule tripped (data = 1) or released (data = 0) (source = rule index)
+} EventTypeEnum;
+
+typedef struct {
+  uint32_t timestamp;     // HAL tick in ms
+  uint8_t type;           // EventTypeEnum
+  uint8_t source;         // Bank, channel or fault bit depending on type
+  uint16_t data;          // Type specific payload
+} Event_t;
+
+typedef struct {
+  uint32_t sequence;          // Record number, increasing across resets
+  uint32_t timestamp;         // HAL tick in ms
+  uint32_t operatingSeconds;  // Lifetime operating time
+  uint8_t type;               // EventTypeEnum
+  uint8_t source;             // As in Event_t
+  uint16_t data;              // As in Event_t
+  uint8_t faults;             // Fault flags at the event
+  uint8_t state;              // System state at the event
+  uint16_t reserved;
+  uint16_t voltages[VOLTAGE_COUNT]; // Voltages at the event in mV
+  uint32_t checksum;          // Inverted sum of the preceding words
+} JournalRecord_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the event log module
+  * @retval None
+  */
+void EVENT_Init(void);
+
+/**
+  * @brief  Record an event
+  * @param  type: Event type (EventTypeEnum)
+  * @param  source: Event source
+  * @param  data: Event payload
+  * @retval None
+  */
+void EVENT_Post(uint8_t type, uint8_t source, uint16_t data);
+
+/**
+  * @brief  Get number of events currently held in the log
+  * @retval Number of events
+  */
+uint8_t EVENT_GetCount(void);
+
+/**
+  * @brief  Read an event from the log
+  * @param  index: Event index (0 = oldest)
+  * @param  event: Pointer to store the event
+  * @retval 1 if the event exists, 0 otherwise
+  */
+uint8_t EVENT_Get(uint8_t index, Event_t* event);
+
+/**
+  * @brief  Perform one bounded step of journal programming or erasing
+  * @retval None
+  */
+void EVENT_Update(void);
+
+/**
+  * @brief  Get number of records held in the flash journal
+  * @retval Number of records
+  */
+uint16_t EVENT_GetJournalCount(void);
+
+/**
+  * @brief  Get number of records lost because the journal queue was full
+  * @retval Number of records
+  */
+uint32_t EVENT_GetJournalDropped(void);
+
+/**
+  * @brief  Read a record from the flash journal
+  * @param  index: Record index (0 = oldest)
+  * @param  record: Pointer to store the record
+  * @retval 1 if the record exists, 0 otherwise
+  */
+uint8_t EVENT_GetJournal(uint16_t index, JournalRecord_t* record);
+
+/**
+  * @brief  Erase the flash journal (performed in steps by EVENT_Update)
+  * @retval None
+  */
+void EVENT_ClearJournal(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EVENT_LOG_H */
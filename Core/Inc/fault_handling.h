@@ -21,26 +21,160 @@ extern "C" {
 
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
+#include "timebase.h"
+#include "fault_queue.h"
 
 /* Exported constants --------------------------------------------------------*/
-#define FAULT_TIMEOUT 3000 // Timeout for fault clearing in ms
+#define FAULT_LINE_COUNT 4 // FLT_* inputs, one per line fault bit
+#define FAULT_LINE_MASK (FAULT_BLOCK_200A | FAULT_BLOCK_100A | FAULT_CHARGE | FAULT_FAST_CHARGE)
+#define FAULT_RETRY_RESET_TIME 60000 // ms without a fault after which the retry count restarts
+#define FAULT_DEBOUNCE_US 200   // Line level must be stable this long before it is judged
+#define FAULT_MIN_PULSE_US 1000 // Shorter LOW pulses are rejected as glitches
+#define FAULT_HISTORY_INTERVALS 8 // Inter-arrival times kept per line
+#define FAULT_HISTORY_FLUSH_INTERVAL 3600000 // ms between flash writes of a changed history (1 h)
+#define FAULT_SNAPSHOT_SAMPLES 8 // Filtered frames per snapshot (max ADC_RING_SIZE)
+#define FAULT_SNAPSHOT_COUNT 4   // Snapshots kept, the oldest is overwritten
+#define FAULT_SNAPSHOT_PERSIST_INTERVAL 60000 // Minimum ms between flash writes of the latest snapshot
+
+/*
+ * Input engine: the FLT_* lines (active LOW) interrupt on both edges. The EXTI
+ * callback only timestamps the edge with the DWT cycle counter; the SysTick
+ * tick qualifies a line once its level has been stable for FAULT_DEBOUNCE_US.
+ * A LOW pulse of at least FAULT_MIN_PULSE_US latches the fault, shorter pulses
+ * are counted as glitches. No polling from the main loop is involved.
+ *
+ * Recovery follows a per-line policy once the line is HIGH again. A latching
+ * line stays faulted until FAULT_ClearLatched. An auto-retry line clears
+ * after a hold time that doubles with every retry; when its retry limit is
+ * reached it latches like a latching line. The enables of a faulted line are
+ * released only after the main loop has applied the clear, so they come back
+ * through UpdatePowerOutput/UpdateChargeMode with the requested settings.
+ *
+ * Ownership: line states and the cutoff masks belong to the interrupt side,
+ * faultState belongs to task context. The SysTick qualifier is the only
+ * producer of a lock-free single-producer/single-consumer event queue
+ * (fault_queue.h) and
+ * FAULT_Check, on the preempting scheduler level, is its only consumer;
+ * faultState is derived from the drained events. FAULT_SetFaultFlag and
+ * FAULT_ClearFaultFlag may be called from either level and take the
+ * scheduler lock. If the queue overflows, FAULT_Check resynchronizes
+ * from the latched line mask published by the producer.
+ *
+ * Hard cutoff: the EXTI handlers call FAULT_CutoffFromISR before the HAL
+ * dispatch, which clears the enables mapped to the lines that went LOW with
+ * one BSRR write per port. The enables stay held off while the line is being
+ * qualified or latched, and are released again when a glitch is rejected.
+ * The cycles reported in FaultLineStats_t run from the IRQ handler's first
+ * instruction to the last BSRR write, plus FAULT_EXCEPTION_ENTRY_CYCLES of
+ * hardware stacking. They do not include the time the interrupt was pending
+ * before its handler started. The edge to cutoff worst case is the sum of:
+ *
+ *  - the EXTI input synchronizer, 2-3 APB2 clocks;
+ *  - the longest section with interrupts masked (PRIMASK). The scheduler lock
+ *    uses BASEPRI and does not mask priority 0, but these sections do:
+ *    FAULT_TickFromISR masks its whole qualifier pass, measured every tick
+ *    and reported as maskedCycles in FaultQueueStats_t, and it is the
+ *    longest. TIMEBASE_Now, the system control WriteEnable, the output
+ *    check CheckPins, FAULT_ClearLatched and UpdateBlockedOutputs mask for
+ *    a few tens of cycles each. The Sleep and Stop exits in POWER_Idle keep
+ *    interrupts masked only for their timebase correction;
+ *  - the PVD handler, also at priority 0 and ahead of the EXTI lines on a
+ *    tie. It never returns, it saves the emergency record and resets, but
+ *    its first action is SYSTEM_ForceSafeOutputs, which clears every enable.
+ *    A fault during a supply drop therefore waits at most the PVD entry plus
+ *    that call, and the outputs are already off;
+ *  - the counted handler time, maxCycles.
+ *
+ * Flash stalls are not part of the sum, see below. Crash handling masks
+ * interrupts as well, but drives the outputs off itself.
+ *
+ * A flash page erase (event journal, NVM compaction) stalls every fetch from
+ * flash for up to 40 ms. FAULT_Init therefore moves the vector table to RAM
+ * (VTOR), and the EXTI handlers, FAULT_CutoffFromISR and the line table are
+ * placed in RAM as well, so the cutoff never waits on an erase. The HAL
+ * dispatch after the cutoff still runs from flash and may be held off by it.
+ */
+#define FAULT_EXCEPTION_ENTRY_CYCLES 12 // Cortex-M3 exception entry, zero wait state
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+  uint32_t faults;        // Qualified fault pulses
+  uint32_t glitches;      // Pulses rejected as shorter than FAULT_MIN_PULSE_US
+  uint32_t lastPulseUs;   // Width of the last qualified pulse
+  uint32_t maxPulseUs;    // Widest qualified pulse
+  uint32_t lastGlitchUs;  // Width of the last rejected pulse
+  uint32_t cutoffs;       // Cutoffs performed from the EXTI handler
+  uint32_t lastCycles;    // Latency of the last cutoff in CPU cycles
+  uint32_t maxCycles;     // Worst cutoff latency seen
+  uint32_t retries;       // Automatic clears since the last quiet period
+  uint32_t lockouts;      // Retry limit reached, latched until cleared
+} FaultLineStats_t;
+
+/* Lifetime history of one line, persisted under NVM_TAG_FAULT_HISTORY */
+typedef struct {
+  uint32_t events;        // Qualified pulses
+  uint32_t activeMs;      // Cumulative LOW time of the qualified pulses
+  uint32_t longestMs;     // Longest qualified pulse
+  uint32_t lastSeconds;   // Operating seconds at the last pulse
+  uint32_t intervals[FAULT_HISTORY_INTERVALS]; // Last inter-arrival times in ms, ring
+  uint16_t hourEvents;    // Pulses in the current operating hour
+  uint16_t lastHourEvents; // Pulses in the last complete operating hour
+  uint16_t maxHourEvents; // Most pulses in one operating hour
+  uint8_t intervalHead;   // Next interval slot to write
+  uint8_t intervalCount;  // Valid intervals
+} FaultLineHistory_t;
+
+typedef struct {
+  FaultLineHistory_t lines[FAULT_LINE_COUNT]; // Indexed by fault bit
+  uint32_t hourStart;     // Operating seconds the current hour started
+} FaultHistory_t;
+
+/* System around a latched fault, taken when its EVENT_FAULT is posted. The
+   ring is kept in RAM; only the latest snapshot is persisted, under
+   NVM_TAG_FAULT_SNAPSHOT, at most once per FAULT_SNAPSHOT_PERSIST_INTERVAL,
+   and restored as the first entry at boot. A burst of faults therefore keeps
+   its last snapshot across a reset, the earlier ones are lost. */
+typedef struct {
+  uint32_t timestamp;     // Timestamp of the EVENT_FAULT it belongs to
+  uint32_t operatingSeconds; // Lifetime operating time, matches the journal record after a reset
+  uint8_t fault;          // FaultStateEnum bit that latched
+  uint8_t faults;         // All fault flags after latching
+  uint8_t chargeMode;     // Commanded ChargeModeEnum
+  uint8_t chargeInhibit;  // Charge inhibit sources (OutputInhibitEnum)
+  uint8_t output;         // 1 if the power output was driven on
+  uint8_t relay;          // Debounced relay feedback position (LatchPositionEnum)
+  uint8_t samples;        // Valid frames in mv
+  uint8_t restored;       // 1 if restored from flash, taken before the last reset
+  uint16_t mv[FAULT_SNAPSHOT_SAMPLES][VOLTAGE_COUNT]; // Filtered frames up to the fault, oldest first
+} FaultSnapshot_t;
+
+typedef struct {
+  FaultSnapshot_t entries[FAULT_SNAPSHOT_COUNT];
+  uint8_t head;           // Next entry to write
+  uint8_t count;          // Valid entries
+  uint16_t reserved;
+} FaultSnapshots_t;
 
 /* Exported function prototypes ----------------------------------------------*/
 
 /**
   * @brief  Initialize the fault handling module
+  * @note   Lines already LOW are qualified like a fresh edge; NVM_Init
+  *         must have been called (history)
   * @retval None
   */
 void FAULT_Init(void);
 
 /**
-  * @brief  Check for faults
+  * @brief  Drain the fault event queue and update the fault state
+  * @note   Preempting scheduler level only
   * @retval None
   */
 void FAULT_Check(void);
 
 /**
   * @brief  Set fault flag
+  * @note   Task context, either scheduler level
   * @param  fault: Fault flag to set
   * @retval None
   */
@@ -48,6 +182,7 @@ void FAULT_SetFaultFlag(uint8_t fault);
 
 /**
   * @brief  Clear fault flag
+  * @note   Task context, either scheduler level
   * @param  fault: Fault flag to clear
   * @retval None
   */
@@ -59,6 +194,74 @@ void FAULT_ClearFaultFlag(uint8_t fault);
   */
 uint8_t FAULT_GetState(void);
 
+/**
+  * @brief  De-assert the enables mapped to fault lines that went LOW
+  * @note   Called first thing in the EXTI IRQ handlers
+  * @param  entryCycles: DWT->CYCCNT read on handler entry
+  * @retval None
+  */
+void FAULT_CutoffFromISR(uint32_t entryCycles);
+
+/**
+  * @brief  Record an edge on a fault line
+  * @note   Called from HAL_GPIO_EXTI_Callback
+  * @param  pin: FLT_* pin that triggered
+  * @retval None
+  */
+void FAULT_EdgeFromISR(uint16_t pin);
+
+/**
+  * @brief  Debounce and qualify the fault lines
+  * @note   Called from the SysTick handler every 1 ms
+  * @retval None
+  */
+void FAULT_TickFromISR(void);
+
+/**
+  * @brief  Get enable pins held off by active faults
+  * @param  port: GPIOA or GPIOB
+  * @retval Pin mask that must not be driven high
+  */
+uint16_t FAULT_GetBlockedOutputs(GPIO_TypeDef* port);
+
+/**
+  * @brief  Get per-line pulse and cutoff statistics
+  * @retval Array of FAULT_LINE_COUNT entries indexed by fault bit
+  */
+const FaultLineStats_t* FAULT_GetLineStats(void);
+
+/**
+  * @brief  Get fault event queue statistics
+  * @retval Pointer to the statistics
+  */
+const FaultQueueStats_t* FAULT_GetQueueStats(void);
+
+/**
+  * @brief  Clear latched faults whose lines are no longer active
+  * @note   Task context, applied on the next SysTick
+  * @param  faults: Fault flags to clear
+  * @retval None
+  */
+void FAULT_ClearLatched(uint8_t faults);
+
+/**
+  * @brief  Get lines latched until a commanded clear
+  * @retval Fault flags waiting for FAULT_ClearLatched
+  */
+uint8_t FAULT_GetLockedLines(void);
+
+/**
+  * @brief  Get the lifetime fault history of every line
+  * @retval Pointer to the history
+  */
+const FaultHistory_t* FAULT_GetHistory(void);
+
+/**
+  * @brief  Get the snapshots taken on the latest latched faults
+  * @retval Pointer to the snapshots
+  */
+const FaultSnapshots_t* FAULT_GetSnapshots(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,173 @@
+/**
+  ******************************************************************************
+  * @file    fault_queue.h
+  * @brief   Fault event queue between SysTick and the task level
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FAULT_QUEUE_H
+#define __FAULT_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/*
+ * Lock-free single-producer/single-consumer ring. head is written only by
+ * the producer and tail only by the consumer; one slot stays free so that
+ * head == tail means empty. A full queue drops the new event and counts an
+ * overflow, which the consumer picks up with FAULT_QueueOverflowed to rebuild
+ * its state from a level the producer publishes.
+ *
+ * The header does not depend on the HAL so the same code can be run on the
+ * host (Tests/). FAULT_QUEUE_BARRIER orders the slot access against the
+ * index store; on the target it is __DMB() from CMSIS, which must be
+ * included first.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define FAULT_QUEUE_SIZE 16     // Fault events between SysTick and main loop, power of two
+
+#ifndef FAULT_QUEUE_BARRIER
+#define FAULT_QUEUE_BARRIER() __DMB()
+#endif
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  FAULT_EVENT_ASSERT = 0,   // Pulse qualified, fault latched on the first one
+  FAULT_EVENT_RELEASE,      // Line HIGH again, hold time started
+  FAULT_EVENT_CLEAR         // Hold time elapsed, fault cleared
+} FaultEventEnum;
+
+typedef struct {
+  uint64_t time;          // Timebase time (Timestamp_t) of the edge that caused the event
+  uint32_t widthUs;       // Pulse width for FAULT_EVENT_RELEASE
+  uint8_t fault;          // FaultStateEnum bit
+  uint8_t type;           // FaultEventEnum
+} FaultEvent_t;
+
+typedef struct {
+  uint32_t pushed;        // Events queued by the producer
+  uint32_t overflows;     // Events dropped because the queue was full
+  uint32_t resyncs;       // Fault state rebuilt after an overflow
+  uint32_t maskedCycles;  // Longest qualifier pass, interrupts masked, in CPU cycles
+  uint8_t highWater;      // Maximum queue depth seen
+} FaultQueueStats_t;
+
+typedef struct {
+  FaultEvent_t slots[FAULT_QUEUE_SIZE];
+  volatile uint8_t head;  // Next slot to write, producer only
+  volatile uint8_t tail;  // Next slot to read, consumer only
+  uint32_t seenOverflows; // Overflows already handled by the consumer
+  FaultQueueStats_t stats;
+} FaultQueue_t;
+
+/* Exported functions --------------------------------------------------------*/
+
+/**
+  * @brief  Empty the queue and reset its statistics
+  * @note   Neither side may run meanwhile
+  * @param  queue: Queue to reset
+  * @retval None
+  */
+static inline void FAULT_QueueInit(FaultQueue_t* queue)
+{
+  queue->head = 0;
+  queue->tail = 0;
+  queue->seenOverflows = 0;
+  queue->stats.pushed = 0;
+  queue->stats.overflows = 0;
+  queue->stats.resyncs = 0;
+  queue->stats.maskedCycles = 0;
+  queue->stats.highWater = 0;
+}
+
+/**
+  * @brief  Queue an event
+  * @note   Producer side only
+  * @param  queue: Queue to write
+  * @param  event: Event to copy into the queue
+  * @retval 1 if queued, 0 if dropped because the queue was full
+  */
+static inline uint8_t FAULT_QueuePush(FaultQueue_t* queue, const FaultEvent_t* event)
+{
+  uint8_t head = queue->head;
+  uint8_t next = (head + 1) & (FAULT_QUEUE_SIZE - 1);
+
+  if (next == queue->tail) {
+    queue->stats.overflows++;
+    return 0;
+  }
+
+  queue->slots[head] = *event;
+
+  // Publish the slot only after it is written
+  FAULT_QUEUE_BARRIER();
+  queue->head = next;
+
+  queue->stats.pushed++;
+  uint8_t depth = (next - queue->tail) & (FAULT_QUEUE_SIZE - 1);
+  if (depth > queue->stats.highWater) {
+    queue->stats.highWater = depth;
+  }
+  return 1;
+}
+
+/**
+  * @brief  Take the oldest event from the queue
+  * @note   Consumer side only
+  * @param  queue: Queue to read
+  * @param  event: Buffer for the event
+  * @retval 1 if an event was taken, 0 if the queue is empty
+  */
+static inline uint8_t FAULT_QueuePop(FaultQueue_t* queue, FaultEvent_t* event)
+{
+  uint8_t tail = queue->tail;
+
+  if (tail == queue->head) {
+    return 0;
+  }
+
+  *event = queue->slots[tail];
+
+  // Release the slot only after it is read
+  FAULT_QUEUE_BARRIER();
+  queue->tail = (tail + 1) & (FAULT_QUEUE_SIZE - 1);
+  return 1;
+}
+
+/**
+  * @brief  Check for events dropped since the last call
+  * @note   Consumer side only, after draining; counts a resync when it
+  *         returns 1, the caller then rebuilds its state from the level
+  *         published by the producer
+  * @param  queue: Queue to check
+  * @retval 1 if events were dropped, 0 otherwise
+  */
+static inline uint8_t FAULT_QueueOverflowed(FaultQueue_t* queue)
+{
+  uint32_t overflows = queue->stats.overflows;
+
+  if (overflows == queue->seenOverflows) {
+    return 0;
+  }
+  queue->seenOverflows = overflows;
+  queue->stats.resyncs++;
+  return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FAULT_QUEUE_H */
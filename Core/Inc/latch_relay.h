@@ -0,0 +1,135 @@
+/**
+  ******************************************************************************
+  * @file    latch_relay.h
+  * @brief   Latching relay actuation and feedback module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LATCH_RELAY_H
+#define __LATCH_RELAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * LATCH_FB1 closes in the set position, LATCH_FB2 in the reset position.
+ * The feedback is sampled on SysTick and debounced: PB6/PB7 share EXTI
+ * lines 6/7 with FLT_CHARGE/FLT_BLOCK_100A, so they can not interrupt.
+ * A coil pulse ends as soon as the feedback confirms the new position; a
+ * position change nobody commanded is reported as spontaneous. Both raise
+ * FAULT_RELAY, which the next confirmed actuation clears.
+ *
+ * Pulses are requested from task context and queued; the pulse engine runs
+ * on SysTick after the feedback sample, so a request returns at once and
+ * every task keeps running during the pulse. The engine drives one coil at
+ * a time and holds both off for LATCH_MIN_OFF_TIME between pulses,
+ * retries included. A coil switched off behind its back (safe outputs on
+ * a supply drop or crash) or a LATCH_Cancel ends the pulse as aborted and
+ * drops the queue. Outcomes are handed back to LATCH_Update, which keeps
+ * the statistics and raises or clears FAULT_RELAY in task context.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define LATCH_PULSE_TIME        100   // ms maximum coil pulse per attempt
+#define LATCH_RETRY_LIMIT       1     // Extra attempts before FAULT_RELAY is raised
+#define LATCH_MIN_OFF_TIME      50    // ms both coils stay off between two pulses
+#define LATCH_QUEUE_SIZE        8     // Pulse requests and results between tasks and SysTick, power of two
+#define LATCH_DEBOUNCE_TICKS    5     // ms feedback must be stable to count
+#define LATCH_FB_ACTIVE         GPIO_PIN_SET // Level of a closed feedback contact
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  LATCH_POSITION_UNKNOWN = 0,     // Neither contact closed
+  LATCH_POSITION_SET = RELAY_SET,
+  LATCH_POSITION_RESET = RELAY_RESET,
+  LATCH_POSITION_INVALID          // Both contacts closed
+} LatchPositionEnum;
+
+typedef enum {
+  LATCH_RESULT_OK = 0,            // Confirmed on the first pulse
+  LATCH_RESULT_RETRIED,           // Confirmed after a retry
+  LATCH_RESULT_FAILED,            // Not confirmed, FAULT_RELAY raised
+  LATCH_RESULT_SPONTANEOUS,       // Position changed without a command, FAULT_RELAY raised
+  LATCH_RESULT_ABORTED            // Pulse cut short by LATCH_Cancel or the safe outputs
+} LatchResultEnum;
+
+typedef struct {
+  uint32_t actuations;            // Commanded pulses
+  uint32_t retries;               // Repeated pulses
+  uint32_t failures;              // Actuations never confirmed
+  uint32_t spontaneous;           // Uncommanded position changes
+  uint32_t aborted;               // Pulses cut short
+  uint32_t dropped;               // Requests refused with the queue full
+  uint32_t lastActuationUs;       // Coil on to feedback change of the last confirmed actuation
+  uint32_t maxActuationUs;
+  uint8_t position;               // Debounced feedback position (LatchPositionEnum)
+  uint8_t expected;               // Position last commanded or accepted
+  uint8_t lastResult;             // LatchResultEnum of the last actuation
+  uint8_t reserved;
+} LatchStats_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Take the current feedback position as the expected position
+  * @retval None
+  */
+void LATCH_Init(void);
+
+/**
+  * @brief  Take over finished pulses and report position changes that were not commanded
+  * @note   Preempting scheduler level only
+  * @retval None
+  */
+void LATCH_Update(void);
+
+/**
+  * @brief  Queue a coil pulse that lasts until the feedback confirms the position
+  * @note   Task context, either scheduler level; returns at once
+  * @param  target: LATCH_POSITION_SET or LATCH_POSITION_RESET
+  * @retval 1 if queued, 0 if the target is invalid or the queue is full
+  */
+uint8_t LATCH_Request(uint8_t target);
+
+/**
+  * @brief  End the running pulse and drop the queued ones
+  * @note   Task context; both coils are off on return
+  * @retval None
+  */
+void LATCH_Cancel(void);
+
+/**
+  * @brief  Check whether a pulse is running, pending or in its off time
+  * @retval 1 if busy
+  */
+uint8_t LATCH_IsBusy(void);
+
+/**
+  * @brief  Sample and debounce the feedback contacts and run the pulse engine
+  * @note   Called from the SysTick handler every 1 ms
+  * @retval None
+  */
+void LATCH_TickFromISR(void);
+
+/**
+  * @brief  Get actuation statistics and the feedback position
+  * @retval Pointer to the statistics
+  */
+const LatchStats_t* LATCH_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LATCH_RELAY_H */
@@ -0,0 +1,84 @@
+/**
+  ******************************************************************************
+  * @file    lifetime_stats.h
+  * @brief   Lifetime statistics (odometer) module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LIFETIME_STATS_H
+#define __LIFETIME_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "battery_management.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define LIFETIME_CAPACITY_AH      100.0f   // Nominal capacity of one bank
+#define LIFETIME_SOC_STEP         0.01f    // Minimum SoC change counted as throughput
+#define LIFETIME_UPDATE_INTERVAL  1000     // ms between accumulation steps
+#define LIFETIME_FLUSH_INTERVAL   900000   // ms between flash writes (15 min)
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+  float dischargeAh;        // Estimated charge delivered
+  float chargeAh;           // Estimated charge accepted
+  float dischargeWh;        // Estimated energy delivered
+  float chargeWh;           // Estimated energy accepted
+  uint32_t deepDischarges;  // Entries into the critical low-voltage level
+} LifetimeBank_t;
+
+typedef struct {
+  LifetimeBank_t banks[BATTERY_BANK_COUNT];
+  uint32_t stateSeconds[STATE_COUNT]; // Time spent in each SystemStateEnum state
+} LifetimeStats_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the lifetime statistics and restore them from flash
+  * @note   NVM_Init must have been called
+  * @retval None
+  */
+void LIFETIME_Init(void);
+
+/**
+  * @brief  Accumulate statistics and flush them to flash when due
+  * @retval None
+  */
+void LIFETIME_Update(void);
+
+/**
+  * @brief  Get the lifetime statistics
+  * @retval Pointer to the statistics
+  */
+const LifetimeStats_t* LIFETIME_GetStats(void);
+
+/**
+  * @brief  Get total operating time over the unit's lifetime
+  * @retval Seconds spent in all system states
+  */
+uint32_t LIFETIME_GetOperatingSeconds(void);
+
+/**
+  * @brief  Get equivalent full cycles of a bank
+  * @param  bank: BANK_A or BANK_B
+  * @retval Equivalent full cycles (discharged Ah / nominal capacity)
+  */
+float LIFETIME_GetEquivalentCycles(uint8_t bank);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LIFETIME_STATS_H */
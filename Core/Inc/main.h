@@ -53,6 +53,8 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+void USB_DataReceived(uint8_t* buffer, uint32_t length);
+void SystemClock_Config(void);
 
 /* USER CODE END EFP */
 
@@ -113,7 +115,8 @@ typedef enum {
   STATE_STANDBY = 0,
   STATE_CHARGING,
   STATE_DISCHARGING,
-  STATE_ERROR
+  STATE_ERROR,
+  STATE_COUNT
 } SystemStateEnum;
 
 typedef enum {
@@ -121,7 +124,9 @@ typedef enum {
   FAULT_BLOCK_200A = 0x01,
   FAULT_BLOCK_100A = 0x02,
   FAULT_CHARGE = 0x04,
-  FAULT_FAST_CHARGE = 0x08
+  FAULT_FAST_CHARGE = 0x08,
+  FAULT_RELAY = 0x10,
+  FAULT_OUTPUT = 0x20
 } FaultStateEnum;
 
 typedef enum {
@@ -160,6 +165,8 @@ typedef struct {
   uint8_t fault;
   float voltages[VOLTAGE_COUNT];
 } SystemState_t;
+
+extern SystemState_t systemState;
 /* USER CODE END Private defines */
 
 #ifdef __cplusplus
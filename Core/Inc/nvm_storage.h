@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file    nvm_storage.h
+  * @brief   Non-volatile record storage module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __NVM_STORAGE_H
+#define __NVM_STORAGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Reserved flash area, must match the NVM region in STM32F103C8TX_FLASH.ld */
+#define NVM_BASE_ADDRESS      0x0800E000UL
+#define NVM_SIZE              0x2000UL   // 8 KB
+
+/* Record store: two banks used alternately, each bank FLASH_PAGE_SIZE * 2 */
+#define NVM_RECORD_BANK_SIZE  (2 * FLASH_PAGE_SIZE)
+#define NVM_RECORD_BANK_0     NVM_BASE_ADDRESS
+#define NVM_RECORD_BANK_1     (NVM_RECORD_BANK_0 + NVM_RECORD_BANK_SIZE)
+#define NVM_RECORD_MAX_LENGTH 255        // Maximum payload of one record in bytes
+
+/* Event journal: circular page ring after the record store (event_log) */
+#define NVM_JOURNAL_BASE      (NVM_RECORD_BANK_1 + NVM_RECORD_BANK_SIZE)
+#define NVM_JOURNAL_PAGES     3
+
+/* Emergency record page after the journal, slots kept erased for the PVD save (supply_monitor) */
+#define NVM_EMERGENCY_BASE    (NVM_JOURNAL_BASE + NVM_JOURNAL_PAGES * FLASH_PAGE_SIZE)
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  NVM_TAG_NONE = 0,
+  NVM_TAG_LIFETIME,       // Lifetime statistics (lifetime_stats)
+  NVM_TAG_STANDBY,        // Standby drain rate history (standby_monitor)
+  NVM_TAG_EQUALIZE,       // Last equalization record (equalize)
+  NVM_TAG_FAULT_HISTORY,  // Per-line fault history (fault_handling)
+  NVM_TAG_PROTECT_RULES,  // Voltage protection rule table (protection)
+  NVM_TAG_FAULT_SNAPSHOT, // Latest fault snapshot (fault_handling)
+  NVM_TAG_COUNT
+} NvmTagEnum;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the record store and locate the active bank
+  * @retval None
+  */
+void NVM_Init(void);
+
+/**
+  * @brief  Read the latest record stored under a tag
+  * @param  tag: Record tag (NvmTagEnum)
+  * @param  data: Buffer to store the record payload
+  * @param  length: Expected payload length in bytes
+  * @retval 1 if a valid record of that length was found, 0 otherwise
+  */
+uint8_t NVM_Read(uint8_t tag, void* data, uint16_t length);
+
+/**
+  * @brief  Append a new record for a tag
+  * @note   Blocks while programming; when the active bank is full the latest
+  *         record of every tag is copied to the other bank first (page erase).
+  * @param  tag: Record tag (NvmTagEnum)
+  * @param  data: Record payload
+  * @param  length: Payload length in bytes (max NVM_RECORD_MAX_LENGTH)
+  * @retval 1 on success, 0 on flash error
+  */
+uint8_t NVM_Write(uint8_t tag, const void* data, uint16_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NVM_STORAGE_H */
@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  * @file    output_check.h
+  * @brief   Enable output readback self-check module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __OUTPUT_CHECK_H
+#define __OUTPUT_CHECK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * Every OUTCHECK_INTERVAL the EN_* outputs are checked at three levels:
+ * ODR against the commanded state less the fault cutoffs (register
+ * corruption or a stray write), IDR against ODR (pin stuck or shorted on
+ * the board), and the LOAD voltage against the block enables (LOAD follows
+ * the banks with the blocks on and collapses with them off). A mismatch
+ * that persists raises FAULT_OUTPUT until cleared over USB.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define OUTCHECK_INTERVAL         10     // ms between checks
+#define OUTCHECK_SIGNAL_COUNT     4      // EN_* outputs, SYSTEM_SetEnableSignal index order
+#define OUTCHECK_GPIO_PERSIST     3      // Consecutive GPIO mismatches before the fault
+#define OUTCHECK_LOAD_PERSIST     50     // Consecutive LOAD mismatches before the fault (500 ms)
+#define OUTCHECK_SETTLE_TIME      2000   // ms after a block change before LOAD is judged
+#define OUTCHECK_LOAD_ON_RATIO    0.8f   // With blocks on LOAD must reach this share of the higher bank
+#define OUTCHECK_LOAD_OFF_VOLTAGE 2.0f   // With blocks off LOAD must fall below this
+#define OUTCHECK_LOAD_MIN_BANK    9.0f   // Below this bank voltage LOAD is not judged
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  OUTCHECK_FAIL_LOAD_ON = 0x10,   // failed bit: LOAD missing with the blocks on
+  OUTCHECK_FAIL_LOAD_OFF = 0x20   // failed bit: LOAD present with the blocks off
+} OutputCheckFailEnum;
+
+typedef struct {
+  uint32_t checks;                                // Checks run
+  uint16_t odrMismatches[OUTCHECK_SIGNAL_COUNT];  // Samples with ODR different from the command
+  uint16_t idrMismatches[OUTCHECK_SIGNAL_COUNT];  // Samples with the pin level different from ODR
+  uint16_t loadOnMismatches;                      // Samples with LOAD missing, blocks on
+  uint16_t loadOffMismatches;                     // Samples with LOAD present, blocks off
+  uint16_t faultsRaised;                          // Persistent mismatches that raised FAULT_OUTPUT
+  uint8_t failed;   // Signal bits (1 << index) and OutputCheckFailEnum bits of persistent mismatches
+  uint8_t reserved;
+} OutputCheckStats_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the output self-check
+  * @retval None
+  */
+void OUTCHECK_Init(void);
+
+/**
+  * @brief  Compare the enable outputs with their command and the LOAD voltage
+  * @note   Call after SYSTEM_Update so the outputs were just written
+  * @retval None
+  */
+void OUTCHECK_Update(void);
+
+/**
+  * @brief  Clear FAULT_OUTPUT and the persistent mismatches
+  * @note   Counters are kept; a mismatch still present raises the fault again
+  * @retval None
+  */
+void OUTCHECK_Clear(void);
+
+/**
+  * @brief  Get self-check counters
+  * @retval Pointer to the counters
+  */
+const OutputCheckStats_t* OUTCHECK_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OUTPUT_CHECK_H */
@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file    power_manager.h
+  * @brief   Low-power idle module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __POWER_MANAGER_H
+#define __POWER_MANAGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * The main loop calls POWER_Idle after every scheduler pass. With no task
+ * released the core waits for the next interrupt in Sleep mode; SysTick
+ * keeps counting there, so the DWT timebase is topped up by any cycles it
+ * missed and nothing else notices.
+ *
+ * After POWER_STOP_HOLD_MS in STATE_STANDBY with the outputs and charging
+ * off, no fault and no USB host, Stop mode is used instead. The scheduler
+ * tick is paused, the RTC alarm (LSI / POWER_RTC_PRESCALER) ends each Stop
+ * after POWER_STOP_PERIOD counts and the fault EXTI lines and the PVD end
+ * it at once. On wake the fault handlers run first, on the 8 MHz HSI, then
+ * the clock tree is restored and the HAL tick and the DWT timebase are
+ * advanced by the time stopped, measured on the RTC. The RTC rate is
+ * calibrated against SysTick while awake.
+ *
+ * Fault wake-up bound: from a fault edge in Stop to the cutoff handler takes
+ * the regulator wake-up (5.4 us typical, low-power regulator) plus the
+ * handler entry on the HSI, within POWER_STOP_WAKE_BOUND_US. Full-speed
+ * operation resumes after the HSE and PLL start, reported as maxRestoreUs.
+ *
+ * The IWDG keeps running in Stop. The alarm is counted on the same LSI, so
+ * a Stop always lasts a quarter of the IWDG timeout whatever the LSI rate,
+ * and at most 333 ms at the slowest LSI, inside every task deadline.
+ * A wake by the alarm stays up POWER_STOP_AWAKE_MS so every task runs and
+ * checks in; any other wake stays up POWER_WAKE_HOLD_MS. The ADC is polled
+ * per frame and stops with the core, so the alarm wake takes the frame
+ * instead of an analog watchdog.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define POWER_STOP_HOLD_MS        60000  // ms in STATE_STANDBY before Stop mode is used
+#define POWER_STOP_PERIOD         250    // RTC counts (nominal ms) per Stop, a quarter of the IWDG timeout
+#define POWER_STOP_AWAKE_MS       20     // ms awake after an alarm wake
+#define POWER_WAKE_HOLD_MS        1000   // ms awake after a wake by a fault or PVD line
+#define POWER_STOP_WAKE_BOUND_US  50     // Fault edge in Stop to the cutoff handler
+#define POWER_RTC_PRESCALER       40     // LSI / 40 = 1 kHz nominal RTC count
+#define POWER_RTC_NOMINAL         1000   // RTC counts per second at the nominal 40 kHz LSI
+#define POWER_CAL_SPAN_MS         10000  // Awake time the RTC calibration averages over
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  POWER_MODE_RUN = 0,
+  POWER_MODE_SLEEP,
+  POWER_MODE_STOP
+} PowerModeEnum;
+
+typedef struct {
+  uint32_t sleepMs;       // Time spent in Sleep mode
+  uint32_t stopMs;        // Time spent in Stop mode
+  uint32_t sleepWakes;    // Sleep mode entries
+  uint32_t stopWakes;     // Stop mode entries
+  uint32_t alarmWakes;    // Stop mode entries ended by the RTC alarm, the rest by a fault or PVD line
+  uint16_t lastRestoreUs; // Clock restore after the last Stop (HSE and PLL start)
+  uint16_t maxRestoreUs;  // Longest clock restore after Stop
+  uint16_t rtcPerSecond;  // RTC counts per second, calibrated against SysTick
+  uint8_t stopReady;      // 1 if the RTC runs from the LSI and Stop mode can be used
+  uint8_t lastMode;       // PowerModeEnum of the last idle period
+} PowerStatus_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Start the RTC on the LSI for the Stop mode alarm
+  * @note   WATCHDOG_Init must have been called (backup domain access)
+  * @retval None
+  */
+void POWER_Init(void);
+
+/**
+  * @brief  Sleep until the next interrupt, or Stop during long standby
+  * @note   Main loop only, after the scheduler pass
+  * @retval None
+  */
+void POWER_Idle(void);
+
+/**
+  * @brief  Acknowledge the RTC alarm that ends a Stop
+  * @note   Called from the RTC alarm interrupt
+  * @retval None
+  */
+void POWER_AlarmFromISR(void);
+
+/**
+  * @brief  Get residency and wake counts
+  * @retval Pointer to the status
+  */
+const PowerStatus_t* POWER_GetStatus(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __POWER_MANAGER_H */
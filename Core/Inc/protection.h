@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file    protection.h
+  * @brief   Voltage protection rules module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PROTECTION_H
+#define __PROTECTION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * Every sample frame the rule table is evaluated against the four voltage
+ * channels. A rule trips once its channel has been past the threshold for
+ * qualifyMs and releases once it has been back by hysteresisMv for
+ * releaseMs. The actions of all tripped rules are combined and applied as
+ * inhibit sources, so a channel covered by several rules is released only
+ * when the last of them releases. The table lives in the NVM record store
+ * and falls back to the defaults in flash when no valid record is found.
+ * Evaluation is a fixed loop of integer compares over PROTECT_MAX_RULES,
+ * its cycle count is kept for the USB report.
+ *
+ * The worst frame is one in which every rule changes state: four channel
+ * conversions, PROTECT_MAX_RULES compares, one EVENT_Post per rule, one call
+ * per inhibit source and one relay request. A frame without a change makes
+ * no calls beyond the LED. Tests/protection_test.c checks this bound on a
+ * full table; the cycles it takes on the target are in maxCycles.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define PROTECT_MAX_RULES      12   // Rule table entries
+#define PROTECT_CONFIG_VERSION 1    // Layout version of the stored table
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  PROTECT_ABOVE = 0,  // Trips when the channel rises above the threshold
+  PROTECT_BELOW       // Trips when the channel falls below the threshold
+} ProtectDirectionEnum;
+
+typedef enum {
+  PROTECT_ACTION_INHIBIT_CHARGE = 0x01,  // Hold both charge enables off
+  PROTECT_ACTION_OPEN_OUTPUT = 0x02,     // Open the output blocks
+  PROTECT_ACTION_RELAY_RESET = 0x04,     // Pulse the latch relay to RESET when the rule trips
+  PROTECT_ACTION_ALARM = 0x08            // Drive the warning LED
+} ProtectActionEnum;
+
+typedef struct {
+  uint8_t channel;        // VoltageEnum
+  uint8_t direction;      // ProtectDirectionEnum
+  uint8_t actions;        // ProtectActionEnum bits, 0 = rule disabled
+  uint8_t reserved;
+  uint16_t thresholdMv;   // Trip threshold
+  uint16_t hysteresisMv;  // Distance back from the threshold before release
+  uint16_t qualifyMs;     // Time past the threshold before the rule trips
+  uint16_t releaseMs;     // Time back within hysteresis before the rule releases
+} ProtectRule_t;
+
+typedef struct {
+  uint8_t count;    // Rules in use
+  uint8_t version;  // PROTECT_CONFIG_VERSION
+  uint16_t reserved;
+  ProtectRule_t rules[PROTECT_MAX_RULES];
+} ProtectConfig_t;
+
+typedef struct {
+  uint16_t active;          // Rule bits (1 << index) currently tripped
+  uint8_t actions;          // Combined ProtectActionEnum bits applied
+  uint8_t fromDefaults;     // 1 if the table was loaded from the flash defaults
+  uint16_t trips;           // Rule trips since boot
+  uint32_t lastCycles;      // DWT cycles of the last evaluation
+  uint32_t maxCycles;       // Worst evaluation seen
+} ProtectStatus_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the protection engine and load the rule table
+  * @note   NVM_Init must have been called
+  * @retval None
+  */
+void PROTECT_Init(void);
+
+/**
+  * @brief  Evaluate every rule on the current sample frame and apply actions
+  * @retval None
+  */
+void PROTECT_Update(void);
+
+/**
+  * @brief  Replace one rule and store the table
+  * @param  index: Rule index (0 to PROTECT_MAX_RULES - 1)
+  * @param  rule: New rule
+  * @retval 1 on success, 0 if the rule is invalid or the write failed
+  */
+uint8_t PROTECT_SetRule(uint8_t index, const ProtectRule_t* rule);
+
+/**
+  * @brief  Restore and store the default rule table
+  * @retval 1 on success, 0 if the write failed
+  */
+uint8_t PROTECT_RestoreDefaults(void);
+
+/**
+  * @brief  Get the rule table in use
+  * @retval Pointer to the table
+  */
+const ProtectConfig_t* PROTECT_GetConfig(void);
+
+/**
+  * @brief  Get the rule states and evaluation timing
+  * @retval Pointer to the status
+  */
+const ProtectStatus_t* PROTECT_GetStatus(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROTECTION_H */
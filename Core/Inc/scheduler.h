@@ -0,0 +1,200 @@
+/**
+  ******************************************************************************
+  * @file    scheduler.h
+  * @brief   Time-triggered scheduler module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SCHEDULER_H
+#define __SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * TIM2 interrupts every 1 ms and SCHED_TickFromISR counts the tick. Each
+ * task runs on one of two levels:
+ *
+ * SCHED_LEVEL_PREEMPT tasks run from a software-pended interrupt
+ * (SCHED_LANE_IRQn, otherwise unused with USB active) at
+ * SCHED_LANE_PRIORITY. The tick pends it, so these tasks start right after
+ * the tick even while a background task is running.
+ * SCHED_LEVEL_BACKGROUND tasks run from SCHED_Run in the main loop.
+ *
+ * On each level the counted ticks are caught up, every task due is marked
+ * ready, and the ready tasks run to completion in registration order. All
+ * tasks share the main stack: a preempting task is an interrupt frame on
+ * top of the background task, so a task costs its table entry and no
+ * stack of its own.
+ *
+ * This stands in for an RTOS because of the part: 20 KB of RAM and 56 KB
+ * of flash for the application, the top 8 KB being the NVM record store.
+ * A preemptive kernel needs a stack per task sized for the deepest path of
+ * that task plus the interrupts on top of it; at the 512-byte minimum of a
+ * CubeMX FreeRTOS build the six tasks would take 3 KB before their control
+ * blocks, the idle task and the kernel heap, and the kernel several KB of
+ * flash. Two levels give the protection path the preemption it needs.
+ *
+ * Each run is measured on the painted stack: the words it used below its
+ * entry are found, counted in maxStack and painted again. Interrupts taken
+ * during a run are part of it, and a background task also counts the
+ * preempting runs it was interrupted by, so the deepest background task is
+ * the bound of the whole stack above SCHED_Run. The scan starts just under
+ * the lowest word used so far, so a run costs about one word access per
+ * word between that mark and its entry.
+ *
+ * A task released again before it ran counts as missed; a task running
+ * longer than its budget counts as an overrun. Neither skips nor aborts
+ * anything, they are reported over USB for tuning the periods.
+ *
+ * Interrupt priorities, from high to low: fault EXTI lines and PVD (0),
+ * SysTick (12), TIM2 scheduler tick (13), preempting level (14), then
+ * thread mode. State shared between the levels is guarded with
+ * SCHED_Lock, which raises BASEPRI to the preempting level only, so the
+ * fault cutoff, SysTick and the tick keep running inside a lock.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define SCHED_MAX_TASKS     8               // Registered tasks, both levels
+#define SCHED_LANE_IRQn     CAN1_SCE_IRQn   // Vector borrowed for the preempting level
+#define SCHED_LANE_PRIORITY 14              // NVIC priority of the preempting level
+#define SCHED_STACK_PAINT   0xA5A5A5A5UL    // Fill of the unused stack, for the peak
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*SchedTask_t)(void);
+
+typedef enum {
+  SCHED_LEVEL_BACKGROUND = 0,  // Runs from SCHED_Run in the main loop
+  SCHED_LEVEL_PREEMPT          // Runs from SCHED_LANE_IRQn, preempts the background
+} SchedLevelEnum;
+
+typedef struct {
+  uint32_t runs;          // Completed runs
+  uint32_t overruns;      // Runs longer than the budget
+  uint32_t missed;        // Releases while the previous one had not run yet
+  uint32_t lastUs;        // Execution time of the last run
+  uint32_t maxUs;         // Longest run
+  uint32_t maxLatencyUs;  // Longest delay from the releasing tick interrupt to the start
+  uint16_t periodMs;      // Release period
+  uint16_t phaseMs;       // Offset of the first release
+  uint16_t budgetUs;      // Execution budget
+  uint8_t level;          // SchedLevelEnum
+  uint8_t reserved;
+  uint16_t maxStack;      // Deepest stack use below the entry of a run in bytes, interrupts included
+} SchedTaskStats_t;
+
+typedef struct {
+  uint32_t ticks;         // Scheduler ticks since SCHED_Start
+  uint32_t maxCatchUp;    // Most ticks handled in one SCHED_Run
+  uint16_t stackPeak;     // Deepest main stack use seen in bytes
+  uint16_t taskBytes;     // RAM per registered task (table entry and statistics)
+  uint8_t taskCount;      // Registered tasks
+  uint8_t reserved[3];
+  SchedTaskStats_t tasks[SCHED_MAX_TASKS]; // In registration order
+} SchedStatus_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the scheduler with no tasks and paint the free stack
+  * @retval None
+  */
+void SCHED_Init(void);
+
+/**
+  * @brief  Register a periodic task
+  * @note   Call before SCHED_Start; registration order is priority order within a level
+  * @param  task: Function run to completion on every release
+  * @param  level: SCHED_LEVEL_BACKGROUND or SCHED_LEVEL_PREEMPT
+  * @param  periodMs: Release period in ms (at least 1)
+  * @param  phaseMs: Offset of the first release in ms, spreads tasks of equal period
+  * @param  budgetUs: Execution time above which a run counts as an overrun
+  * @retval Task index, SCHED_MAX_TASKS if the table is full
+  */
+uint8_t SCHED_AddTask(SchedTask_t task, uint8_t level, uint16_t periodMs, uint16_t phaseMs,
+                      uint16_t budgetUs);
+
+/**
+  * @brief  Start the 1 ms scheduler tick (TIM2 update interrupt)
+  * @retval None
+  */
+void SCHED_Start(void);
+
+/**
+  * @brief  Count one scheduler tick and pend the preempting level
+  * @note   Called from the TIM2 update interrupt every 1 ms
+  * @retval None
+  */
+void SCHED_TickFromISR(void);
+
+/**
+  * @brief  Release and run the preempting tasks
+  * @note   Called from the SCHED_LANE_IRQn handler
+  * @retval None
+  */
+void SCHED_LaneFromISR(void);
+
+/**
+  * @brief  Release and run the background tasks due since the last call
+  * @note   Main loop only
+  * @retval Number of tasks run
+  */
+uint8_t SCHED_Run(void);
+
+/**
+  * @brief  Check whether the background level has nothing left to run
+  * @note   Call with interrupts disabled so no tick slips in before sleeping
+  * @retval 1 if no tick is unhandled and no task is ready
+  */
+uint8_t SCHED_IsIdle(void);
+
+/**
+  * @brief  Pause the scheduler tick
+  * @note   Used around Stop mode; ticks are not counted while paused
+  * @retval None
+  */
+void SCHED_Suspend(void);
+
+/**
+  * @brief  Resume the scheduler tick paused by SCHED_Suspend
+  * @retval None
+  */
+void SCHED_Resume(void);
+
+/**
+  * @brief  Keep the preempting level out of a section shared with it
+  * @note   Nests; interrupts above SCHED_LANE_PRIORITY still run
+  * @retval Key for SCHED_Unlock
+  */
+uint32_t SCHED_Lock(void);
+
+/**
+  * @brief  Leave a section entered with SCHED_Lock
+  * @param  key: Value returned by the matching SCHED_Lock
+  * @retval None
+  */
+void SCHED_Unlock(uint32_t key);
+
+/**
+  * @brief  Get per-task timing statistics and the stack peak
+  * @note   Scans the painted stack for the peak
+  * @retval Pointer to the status
+  */
+const SchedStatus_t* SCHED_GetStatus(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SCHEDULER_H */
@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    standby_monitor.h
+  * @brief   Standby self-discharge monitor module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STANDBY_MONITOR_H
+#define __STANDBY_MONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "battery_management.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define STANDBY_UPDATE_INTERVAL  1000     // ms between voltage accumulations
+#define STANDBY_REST_TIME        1800000  // ms with output and charge off before readings start (30 min)
+#define STANDBY_SAMPLE_INTERVAL  600000   // ms averaged into one rested reading (10 min)
+#define STANDBY_FIT_SAMPLES      12       // Readings per drain rate fit (2 h)
+#define STANDBY_DRAIN_ALARM      50       // Drain rate alarm threshold in 0.1 mV/h
+#define STANDBY_HISTORY_SIZE     8        // Fitted drain rates kept
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+  uint32_t operatingSeconds;               // Lifetime operating time at the fit
+  int16_t drainRate[BATTERY_BANK_COUNT];   // Fitted drain rate in 0.1 mV/h (positive = falling)
+  uint16_t restVoltage[BATTERY_BANK_COUNT]; // Mean rested voltage of the fit in mV
+} StandbyFit_t;
+
+typedef struct {
+  StandbyFit_t entries[STANDBY_HISTORY_SIZE];
+  uint8_t head;   // Next entry to write
+  uint8_t count;  // Valid entries
+  uint8_t alarm;  // Bank bits whose last fit exceeded STANDBY_DRAIN_ALARM
+  uint8_t reserved;
+} StandbyHistory_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the standby monitor and restore its history from flash
+  * @note   NVM_Init must have been called
+  * @retval None
+  */
+void STANDBY_Init(void);
+
+/**
+  * @brief  Take rested readings and fit drain rates while in standby
+  * @retval None
+  */
+void STANDBY_Update(void);
+
+/**
+  * @brief  Get the drain rate history
+  * @retval Pointer to the history
+  */
+const StandbyHistory_t* STANDBY_GetHistory(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STANDBY_MONITOR_H */
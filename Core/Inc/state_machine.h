@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file    state_machine.h
+  * @brief   System state machine module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STATE_MACHINE_H
+#define __STATE_MACHINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define STATE_CHARGER_PRESENT_VOLTAGE 13.0f // CHARGE input above this means a charger is connected
+#define STATE_QUALIFY_TIME            500   // ms a derived state must hold before it is entered
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+  uint16_t counts[STATE_COUNT][STATE_COUNT]; // Transitions [from][to]
+  uint32_t enteredAt[STATE_COUNT];           // Tick of the last entry into each state
+  uint32_t qualifyTime;                      // STATE_QUALIFY_TIME, ms a guard is held before a transition
+  uint32_t lastDelay;                        // ms the last transition came after its qualify time
+  uint32_t maxDelay;                         // Worst delay seen (task late or preempted)
+  uint32_t lastActionUs;                     // Exit action to entry action applied, last transition
+  uint32_t maxActionUs;                      // Slowest transition seen
+} StateStats_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Initialize the state machine in STATE_STANDBY
+  * @retval None
+  */
+void STATE_Init(void);
+
+/**
+  * @brief  Derive the system state and update systemState.state
+  * @retval None
+  */
+void STATE_Update(void);
+
+/**
+  * @brief  Get transition statistics
+  * @retval Pointer to the statistics
+  */
+const StateStats_t* STATE_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STATE_MACHINE_H */
@@ -47,7 +47,6 @@
 
 /* Exported functions prototypes ---------------------------------------------*/
 void NMI_Handler(void);
-void HardFault_Handler(void);
 void MemManage_Handler(void);
 void BusFault_Handler(void);
 void UsageFault_Handler(void);
@@ -55,8 +54,14 @@ void SVC_Handler(void);
 void DebugMon_Handler(void);
 void PendSV_Handler(void);
 void SysTick_Handler(void);
+void PVD_IRQHandler(void);
+void EXTI1_IRQHandler(void);
 void USB_LP_CAN1_RX0_IRQHandler(void);
+void EXTI9_5_IRQHandler(void);
+void TIM2_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void CAN1_SCE_IRQHandler(void);
+void RTC_Alarm_IRQHandler(void);
 
 /* USER CODE END EFP */
 
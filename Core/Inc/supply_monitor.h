@@ -0,0 +1,107 @@
+/**
+  ******************************************************************************
+  * @file    supply_monitor.h
+  * @brief   Supply brown-out detection and emergency save module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SUPPLY_MONITOR_H
+#define __SUPPLY_MONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * The PVD interrupt fires when VDD falls below SUPPLY_PVD_LEVEL. It drives
+ * the outputs off and programs the record the main loop keeps ready into
+ * the next erased slot of the emergency page (NVM_EMERGENCY_BASE); no erase
+ * or formatting is left for the hold-up time. It then waits for the supply
+ * to recover and resets.
+ *
+ * The vector table (see fault_handling.h), PVD_IRQHandler, the save and
+ * SYSTEM_ForceSafeOutputs run from RAM, so a page erase in progress when the
+ * supply sags (event journal, NVM write or compaction) does not delay the
+ * outputs. The save itself has to wait for the erase: at most one page,
+ * 40 ms (tERASE max), since the handler never returns to start the second
+ * page of a compaction. Programming the record adds 15 half-words at up to
+ * 70 us. SUPPLY_SAVE_BOUND_US is the sum; the hold-up of VDD from
+ * SUPPLY_PVD_LEVEL down to the reset threshold must exceed it for a save
+ * during an erase to complete. saveTimeUs in each record is the measured
+ * save time, 0xFFFF if the supply ran out first, and is journaled with
+ * EVENT_POWER_FAIL at the next boot.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define SUPPLY_PVD_LEVEL      PWR_PVDLEVEL_7   // 2.9 V, the earliest warning available
+#define SUPPLY_RECORD_SIZE    32               // Bytes per emergency record slot
+#define SUPPLY_ERASE_WAIT_US  40000            // Longest page erase the save may wait for
+#define SUPPLY_SAVE_BOUND_US  (SUPPLY_ERASE_WAIT_US + 15 * 70) // Worst-case save, hold-up must exceed it
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+  uint32_t sequence;              // Power failures recorded, from 1
+  uint32_t operatingSeconds;      // Lifetime operating time
+  uint32_t tick;                  // HAL tick of the last record update
+  uint8_t faults;                 // Active fault flags (FaultTypeEnum)
+  uint8_t lastFault;              // Fault flags of the most recent assertion
+  uint8_t lockedLines;            // Fault lines locked out
+  uint8_t state;                  // System state (SystemStateEnum)
+  uint16_t voltages[VOLTAGE_COUNT]; // mV (VoltageEnum order)
+  uint32_t checksum;              // Inverted sum of the words above
+  uint16_t saveTimeUs;            // PVD entry to checksum programmed, 0xFFFF if power ran out first
+  uint16_t reported;              // 0xFFFF until journaled at boot
+} SupplyRecord_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Journal the last emergency record and prepare the next slot
+  * @note   EVENT_Init must have been called; may erase the page (boot only)
+  * @retval None
+  */
+void SUPPLY_Init(void);
+
+/**
+  * @brief  Refresh the record kept ready for the emergency save
+  * @retval None
+  */
+void SUPPLY_Update(void);
+
+/**
+  * @brief  Handle a supply drop: outputs off, save the record, reset
+  * @note   Called first in PVD_IRQHandler, does not return. Runs from RAM
+  *         up to the reset, so the outputs drop at once even during a page
+  *         erase; only the save waits for the erase to finish.
+  * @param  entryCycles: DWT->CYCCNT captured on handler entry
+  * @retval None
+  */
+void SUPPLY_PowerFailFromISR(uint32_t entryCycles);
+
+/**
+  * @brief  Get the most recent emergency record
+  * @retval Pointer to the record in flash, NULL if there is none
+  */
+const SupplyRecord_t* SUPPLY_GetLastRecord(void);
+
+/**
+  * @brief  Get the number of free emergency slots
+  * @retval Slots left before the page is erased at boot
+  */
+uint16_t SUPPLY_GetFreeSlots(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SUPPLY_MONITOR_H */
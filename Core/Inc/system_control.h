@@ -22,6 +22,13 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 
+/* Exported types ------------------------------------------------------------*/
+/* Inhibit sources, for the power output and the charge enables */
+typedef enum {
+  INHIBIT_LOW_VOLTAGE = 0x01, // Low-voltage disconnect (battery_management)
+  INHIBIT_PROTECTION = 0x02   // Voltage protection rule (protection)
+} OutputInhibitEnum;
+
 /* Exported function prototypes ----------------------------------------------*/
 
 /**
@@ -69,6 +76,12 @@ void SYSTEM_SetLED(uint8_t ledIndex, uint8_t state);
   */
 void SYSTEM_SetChargeMode(uint8_t mode);
 
+/**
+  * @brief  Get current charge mode
+  * @retval Charge mode (ChargeModeEnum)
+  */
+uint8_t SYSTEM_GetChargeMode(void);
+
 /**
   * @brief  Set power output state
   * @param  state: 0 for off, 1 for on
@@ -76,6 +89,43 @@ void SYSTEM_SetChargeMode(uint8_t mode);
   */
 void SYSTEM_SetPowerOutput(uint8_t state);
 
+/**
+  * @brief  Set or release a power output inhibit
+  * @note   Applied to the output immediately, without waiting for SYSTEM_Update
+  * @param  source: Inhibit source (OutputInhibitEnum)
+  * @param  active: 1 to inhibit the output, 0 to release
+  * @retval None
+  */
+void SYSTEM_SetPowerInhibit(uint8_t source, uint8_t active);
+
+/**
+  * @brief  Get active power output inhibits
+  * @retval Inhibit source flags (OutputInhibitEnum)
+  */
+uint8_t SYSTEM_GetPowerInhibit(void);
+
+/**
+  * @brief  Set or release a charge inhibit
+  * @note   Both charge enables are held off while any inhibit is active;
+  *         the commanded charge mode is kept and resumes on release
+  * @param  source: Inhibit source (OutputInhibitEnum)
+  * @param  active: 1 to inhibit charging, 0 to release
+  * @retval None
+  */
+void SYSTEM_SetChargeInhibit(uint8_t source, uint8_t active);
+
+/**
+  * @brief  Get active charge inhibits
+  * @retval Inhibit source flags (OutputInhibitEnum)
+  */
+uint8_t SYSTEM_GetChargeInhibit(void);
+
+/**
+  * @brief  Check if the power output is actually driven on
+  * @retval 1 if enabled and not inhibited, 0 otherwise
+  */
+uint8_t SYSTEM_IsPowerOutputOn(void);
+
 /**
   * @brief  Set relay mode
   * @param  mode: 0 for off, 1 for set, 2 for reset
@@ -85,12 +135,30 @@ void SYSTEM_SetRelayMode(uint8_t mode);
 
 /**
   * @brief  Set enable signal state
+  * @note   An active inhibit clamps the request to off: the block enables
+  *         follow the power inhibits, the charge enables the charge inhibits
   * @param  signalIndex: 0=EN_FAST_CHARGE, 1=EN_CHARGE, 2=EN_BLOCK_100A, 3=EN_BLOCK_200A
   * @param  state: 0 for off, 1 for on
   * @retval None
   */
 void SYSTEM_SetEnableSignal(uint8_t signalIndex, uint8_t state);
 
+/**
+  * @brief  Get the enable pins last commanded on
+  * @note   Fault cutoffs are not applied, see FAULT_GetBlockedOutputs
+  * @param  port: GPIOA or GPIOB
+  * @retval Pin mask of the port
+  */
+uint16_t SYSTEM_GetCommandedOutputs(GPIO_TypeDef* port);
+
+/**
+  * @brief  Drive every enable and relay coil output off
+  * @note   Register writes only, safe from fault handlers and any ISR;
+  *         placed in RAM for the power-fail path
+  * @retval None
+  */
+void SYSTEM_ForceSafeOutputs(void);
+
 #ifdef __cplusplus
 }
 #endif
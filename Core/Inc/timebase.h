@@ -0,0 +1,94 @@
+/**
+  ******************************************************************************
+  * @file    timebase.h
+  * @brief   High resolution timebase module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TIMEBASE_H
+#define __TIMEBASE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * Monotonic 64-bit time in CPU cycles (13.9 ns at 72 MHz). The DWT cycle
+ * counter supplies the low word; wraps (every ~59 s) are counted on every
+ * read, and TIMEBASE_TickFromISR reads it from SysTick so no wrap is missed.
+ * The counter stands still while the core sleeps; the power manager adds
+ * the missed cycles back with TIMEBASE_Advance. The low word is read through
+ * TIMEBASE_ReadCycles, which Tests/timebase_test.c replaces to run the wrap
+ * extension on the host.
+ */
+
+/* Exported types ------------------------------------------------------------*/
+typedef uint64_t Timestamp_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Start the DWT cycle counter
+  * @note   Call before any module that takes timestamps
+  * @retval None
+  */
+void TIMEBASE_Init(void);
+
+/**
+  * @brief  Keep track of cycle counter wraps
+  * @note   Called from the SysTick handler every 1 ms
+  * @retval None
+  */
+void TIMEBASE_TickFromISR(void);
+
+/**
+  * @brief  Get the current time
+  * @note   Safe from any context
+  * @retval Cycles since TIMEBASE_Init
+  */
+Timestamp_t TIMEBASE_Now(void);
+
+/**
+  * @brief  Read the cycle counter that supplies the low word
+  * @note   Weak so that a host test can supply its own counter
+  * @retval DWT->CYCCNT
+  */
+uint32_t TIMEBASE_ReadCycles(void);
+
+/**
+  * @brief  Extend a raw DWT->CYCCNT capture to a full timestamp
+  * @param  cycles: Capture taken less than one wrap period ago
+  * @retval Timestamp of the capture
+  */
+Timestamp_t TIMEBASE_FromCycles(uint32_t cycles);
+
+/**
+  * @brief  Add cycles the counter missed while the core clock was stopped
+  * @note   Call with interrupts disabled
+  * @param  cycles: Cycles to add, less than one wrap period
+  * @retval None
+  */
+void TIMEBASE_Advance(uint32_t cycles);
+
+/**
+  * @brief  Convert a timestamp to microseconds
+  * @param  timestamp: Time in cycles
+  * @retval Microseconds since TIMEBASE_Init
+  */
+uint64_t TIMEBASE_ToMicros(Timestamp_t timestamp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TIMEBASE_H */
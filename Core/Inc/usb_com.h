@@ -22,6 +22,28 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "usbd_cdc_if.h"
+#include "lifetime_stats.h"
+#include "state_machine.h"
+#include "standby_monitor.h"
+#include "equalize.h"
+#include "fault_handling.h"
+#include "event_log.h"
+#include "adc.h"
+#include "watchdog.h"
+#include "crash_report.h"
+#include "supply_monitor.h"
+#include "latch_relay.h"
+#include "output_check.h"
+#include "protection.h"
+#include "scheduler.h"
+#include "power_manager.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Binary responses: sync, type, version, then the payload and a 16-bit sum of
+   all preceding bytes, little-endian, structures in their ARM memory layout */
+#define USB_BINARY_SYNC           0xA5
+#define USB_FAULT_HISTORY_VERSION 1
+#define USB_FAULT_SNAPSHOT_VERSION 2
 
 /* Exported function prototypes ----------------------------------------------*/
 
@@ -39,6 +61,140 @@ void USB_SendStatus(SystemState_t* state);
   */
 void USB_SendError(const char* errorMsg);
 
+/**
+  * @brief  Send lifetime statistics over USB
+  * @param  stats: Pointer to lifetime statistics
+  * @retval None
+  */
+void USB_SendLifetimeStats(const LifetimeStats_t* stats);
+
+/**
+  * @brief  Send state machine statistics over USB
+  * @param  stats: Pointer to state machine statistics
+  * @retval None
+  */
+void USB_SendStateStats(const StateStats_t* stats);
+
+/**
+  * @brief  Send standby drain rate history over USB
+  * @param  history: Pointer to drain rate history
+  * @retval None
+  */
+void USB_SendDrainHistory(const StandbyHistory_t* history);
+
+/**
+  * @brief  Send equalization scheduler status over USB
+  * @param  status: Pointer to equalization status
+  * @retval None
+  */
+void USB_SendEqualizeStatus(const EqualizeStatus_t* status);
+
+/**
+  * @brief  Send fault line pulse, cutoff and event queue statistics over USB
+  * @param  stats: Array of FAULT_LINE_COUNT entries indexed by fault bit
+  * @param  queue: Pointer to fault event queue statistics
+  * @retval None
+  */
+void USB_SendFaultLineStats(const FaultLineStats_t* stats, const FaultQueueStats_t* queue);
+
+/**
+  * @brief  Send latched fault status over USB
+  * @param  faults: Current fault flags
+  * @param  locked: Fault flags waiting for a commanded clear
+  * @param  stats: Array of FAULT_LINE_COUNT entries indexed by fault bit
+  * @retval None
+  */
+void USB_SendLatchStatus(uint8_t faults, uint8_t locked, const FaultLineStats_t* stats);
+
+/**
+  * @brief  Send one chunk of the flash event journal over USB
+  * @param  chunk: Chunk number, EVENT_JOURNAL_CHUNK records each (0 = oldest)
+  * @retval None
+  */
+void USB_SendJournalChunk(uint16_t chunk);
+
+/**
+  * @brief  Send the watchdog reset report and task liveness over USB
+  * @param  status: Pointer to the watchdog status
+  * @retval None
+  */
+void USB_SendWatchdogStatus(const WatchdogStatus_t* status);
+
+/**
+  * @brief  Send the saved crash report over USB
+  * @param  report: Pointer to the report, NULL if there is none
+  * @retval None
+  */
+void USB_SendCrashReport(const CrashReport_t* report);
+
+/**
+  * @brief  Send the last emergency record over USB
+  * @param  record: Pointer to the record, NULL if there is none
+  * @param  freeSlots: Emergency slots left
+  * @retval None
+  */
+void USB_SendSupplyRecord(const SupplyRecord_t* record, uint16_t freeSlots);
+
+/**
+  * @brief  Send relay actuation statistics over USB
+  * @param  stats: Pointer to the statistics
+  * @retval None
+  */
+void USB_SendLatchRelayStats(const LatchStats_t* stats);
+
+/**
+  * @brief  Send output self-check counters over USB
+  * @param  stats: Pointer to the counters
+  * @retval None
+  */
+void USB_SendOutputCheckStats(const OutputCheckStats_t* stats);
+
+/**
+  * @brief  Send the per-line fault history as one binary frame
+  * @note   Frame: USB_BINARY_SYNC, 'N', USB_FAULT_HISTORY_VERSION, line count,
+  *         uint32 operating seconds, FaultHistory_t, uint16 byte sum
+  * @param  history: Pointer to the history
+  * @retval None
+  */
+void USB_SendFaultHistory(const FaultHistory_t* history);
+
+/**
+  * @brief  Send the fault snapshots as one binary frame
+  * @note   Frame: USB_BINARY_SYNC, 'Z', USB_FAULT_SNAPSHOT_VERSION, snapshot count,
+  *         FaultSnapshot_t entries oldest first, uint16 byte sum
+  * @param  snapshots: Pointer to the snapshots
+  * @retval None
+  */
+void USB_SendFaultSnapshots(const FaultSnapshots_t* snapshots);
+
+/**
+  * @brief  Send the protection rule table and rule states over USB
+  * @param  config: Pointer to the rule table
+  * @param  status: Pointer to the rule states
+  * @retval None
+  */
+void USB_SendProtectionStatus(const ProtectConfig_t* config, const ProtectStatus_t* status);
+
+/**
+  * @brief  Send scheduler task timing over USB
+  * @param  status: Pointer to the scheduler status
+  * @retval None
+  */
+void USB_SendSchedulerStatus(const SchedStatus_t* status);
+
+/**
+  * @brief  Send low-power residency and wake counts over USB
+  * @param  status: Pointer to the power manager status
+  * @retval None
+  */
+void USB_SendPowerStatus(const PowerStatus_t* status);
+
+/**
+  * @brief  Check whether a USB host has configured the device
+  * @retval 1 if configured
+  */
+uint8_t USB_IsConfigured(void);
+
 /**
   * @brief  Handle received USB data
   * @param  buffer: Pointer to received data
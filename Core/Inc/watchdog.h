@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file    watchdog.h
+  * @brief   Independent watchdog and task liveness module header
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __WATCHDOG_H
+#define __WATCHDOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/*
+ * The IWDG is refreshed from the main loop only while every task has checked
+ * in within its deadline. Deadlines are checked from SysTick, so a task that
+ * misses one is recorded in the backup registers even when the main loop is
+ * stuck; refreshing then stops and the IWDG resets the MCU. At the next boot
+ * the reset cause and the late task are reported and journaled.
+ */
+
+/* Exported constants --------------------------------------------------------*/
+#define WATCHDOG_TIMEOUT          1000   // ms IWDG timeout at nominal LSI (40 kHz, 30..60 kHz)
+#define WATCHDOG_NO_TASK          0xFF   // No task missed its deadline
+
+/* Backup registers holding the missed task across the reset */
+#define WATCHDOG_BKP_MAGIC        0x5744 // 'WD', record valid
+#define WATCHDOG_BKP_TAG          DR1
+#define WATCHDOG_BKP_TASK         DR2
+#define WATCHDOG_BKP_AGE          DR3
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  WATCHDOG_TASK_ACQUISITION = 0, // ADC frame read
+  WATCHDOG_TASK_PROTECTION,      // Fault event handling
+  WATCHDOG_TASK_COMMS,           // USB command processing
+  WATCHDOG_TASK_BATTERY,         // Battery and low-voltage disconnect
+  WATCHDOG_TASK_COUNT
+} WatchdogTaskEnum;
+
+typedef enum {
+  WATCHDOG_RESET_UNKNOWN = 0,
+  WATCHDOG_RESET_POWER_ON,
+  WATCHDOG_RESET_PIN,
+  WATCHDOG_RESET_SOFTWARE,
+  WATCHDOG_RESET_IWDG,
+  WATCHDOG_RESET_WWDG,
+  WATCHDOG_RESET_LOW_POWER
+} WatchdogResetEnum;
+
+typedef struct {
+  uint8_t resetReason;                     // Cause of the last reset (WatchdogResetEnum)
+  uint8_t missedTask;                      // Task that missed its deadline before it, or WATCHDOG_NO_TASK
+  uint16_t missedAge;                      // ms since that task's last checkin when it was caught
+  uint32_t lastCheckin[WATCHDOG_TASK_COUNT]; // Tick of each task's last checkin
+  uint32_t maxGap[WATCHDOG_TASK_COUNT];    // Longest ms between two checkins of each task
+} WatchdogStatus_t;
+
+/* Exported function prototypes ----------------------------------------------*/
+
+/**
+  * @brief  Report the last reset and start the IWDG
+  * @note   EVENT_Init must have been called; the IWDG cannot be stopped again
+  * @retval None
+  */
+void WATCHDOG_Init(void);
+
+/**
+  * @brief  Refresh the IWDG if no task has missed its deadline
+  * @note   Called once per main loop pass
+  * @retval None
+  */
+void WATCHDOG_Update(void);
+
+/**
+  * @brief  Mark a task as alive
+  * @param  task: Task checking in (WatchdogTaskEnum)
+  * @retval None
+  */
+void WATCHDOG_Checkin(uint8_t task);
+
+/**
+  * @brief  Check task deadlines and record the first miss
+  * @note   Called from the SysTick handler every 1 ms
+  * @retval None
+  */
+void WATCHDOG_TickFromISR(void);
+
+/**
+  * @brief  Get the reset report and task liveness
+  * @retval Pointer to the status
+  */
+const WatchdogStatus_t* WATCHDOG_GetStatus(void);
+
+/**
+  * @brief  Get the deadline of a task
+  * @param  task: Task (WatchdogTaskEnum)
+  * @retval Deadline in ms
+  */
+uint32_t WATCHDOG_GetDeadline(uint8_t task);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __WATCHDOG_H */
@@ -21,7 +21,14 @@
 #include "adc.h"
 
 /* USER CODE BEGIN 0 */
-
+#include <string.h>
+
+static float filteredVoltages[VOLTAGE_COUNT];
+static uint8_t filterPrimed = 0;
+static Timestamp_t frameTime = 0;
+static uint16_t frameRing[ADC_RING_SIZE][VOLTAGE_COUNT]; // Filtered frames in mV
+static uint8_t ringHead = 0;   // Next frame to write
+static uint8_t ringCount = 0;  // Valid frames
 /* USER CODE END 0 */
 
 ADC_HandleTypeDef hadc2;
@@ -177,6 +184,8 @@ float ADC_ConvertToVoltage(uint16_t adcValue)
   */
 void ADC_ReadAll(float* voltages)
 {
+  frameTime = TIMEBASE_Now();
+
   // Read LOAD voltage (ADC channel 1 - PA1)
   voltages[LOAD] = ADC_ConvertToVoltage(ADC_ReadChannel(ADC_CHANNEL_1));
 
@@ -188,5 +197,69 @@ void ADC_ReadAll(float* voltages)
 
   // Read CHARGE voltage (ADC channel 4 - PA4)
   voltages[CHARGE] = ADC_ConvertToVoltage(ADC_ReadChannel(ADC_CHANNEL_4));
+
+  // Update exponential moving average of every channel
+  for (int i = 0; i < VOLTAGE_COUNT; i++) {
+    if (filterPrimed) {
+      filteredVoltages[i] += (voltages[i] - filteredVoltages[i]) * ADC_FILTER_ALPHA;
+    } else {
+      filteredVoltages[i] = voltages[i];
+    }
+
+    float mv = filteredVoltages[i] * 1000.0f;
+    frameRing[ringHead][i] = (mv > 0.0f) ? (uint16_t)mv : 0;
+  }
+  filterPrimed = 1;
+
+  ringHead = (ringHead + 1) % ADC_RING_SIZE;
+  if (ringCount < ADC_RING_SIZE) {
+    ringCount++;
+  }
+}
+
+/**
+  * @brief  Get the low-pass filtered voltage of a channel
+  * @param  channel: Voltage channel (VoltageEnum)
+  * @retval Filtered voltage in volts
+  */
+float ADC_GetFiltered(uint8_t channel)
+{
+  if (channel >= VOLTAGE_COUNT) {
+    return 0.0f;
+  }
+  return filteredVoltages[channel];
+}
+
+/**
+  * @brief  Get the time the last ADC_ReadAll frame was sampled
+  * @retval Timebase time of the first conversion of the frame
+  */
+Timestamp_t ADC_GetFrameTime(void)
+{
+  return frameTime;
+}
+
+/**
+  * @brief  Copy the newest filtered frames from the acquisition ring
+  * @param  frames: Array to store the frames in mV, oldest first
+  * @param  count: Frames wanted (max ADC_RING_SIZE)
+  * @retval Frames copied, fewer than count until the ring has filled
+  */
+uint8_t ADC_CopyRecent(uint16_t (*frames)[VOLTAGE_COUNT], uint8_t count)
+{
+  if (count > ringCount) {
+    count = ringCount;
+  }
+
+  // At most two contiguous runs: up to the end of the ring, then from its start
+  uint8_t start = (ringHead + ADC_RING_SIZE - count) % ADC_RING_SIZE;
+  uint8_t first = ADC_RING_SIZE - start;
+  if (first > count) {
+    first = count;
+  }
+
+  memcpy(frames, frameRing[start], first * sizeof(frameRing[0]));
+  memcpy(frames + first, frameRing[0], (count - first) * sizeof(frameRing[0]));
+  return count;
 }
 /* USER CODE END 1 */
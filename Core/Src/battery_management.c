@@ -13,10 +13,45 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "battery_management.h"
+#include "system_control.h"
+#include "event_log.h"
 #include "gpio.h"
 
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+  float setVoltage;   // Enter level below this voltage
+  float clearVoltage; // Leave level above this voltage
+} AlarmThreshold_t;
+
+typedef struct {
+  uint8_t level;          // Qualified alarm level
+  uint8_t pendingLevel;   // Level waiting for qualification
+  uint32_t pendingSince;  // Tick when pendingLevel was first seen
+} BankAlarm_t;
+
+/* Private constants ---------------------------------------------------------*/
+static const AlarmThreshold_t alarmThresholds[BATTERY_ALARM_COUNT] = {
+  [BATTERY_ALARM_NONE]     = { 0.0f, 0.0f },
+  [BATTERY_ALARM_WARNING]  = { BATTERY_WARNING_SET_VOLTAGE,  BATTERY_WARNING_CLEAR_VOLTAGE },
+  [BATTERY_ALARM_CRITICAL] = { BATTERY_CRITICAL_SET_VOLTAGE, BATTERY_CRITICAL_CLEAR_VOLTAGE },
+  [BATTERY_ALARM_CUTOFF]   = { BATTERY_CUTOFF_SET_VOLTAGE,   BATTERY_CUTOFF_CLEAR_VOLTAGE },
+};
+
 /* Private variables ---------------------------------------------------------*/
-static uint8_t batteryLowFlag = 0;
+static BankAlarm_t bankAlarms[BATTERY_BANK_COUNT];
+static uint8_t lvdDisconnected = 0;  // Output held open by low-voltage disconnect
+static uint8_t lvdRecovering = 0;    // Reconnect holdoff running
+static uint32_t lvdRecoverySince = 0;
+static uint8_t lvdGatingBank = BANK_A; // Last bank that held the reconnect off
+static uint8_t lvdDipping = 0;         // A bank is below the hysteresis band during the holdoff
+static uint32_t lvdDipSince = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t GetTargetAlarm(uint8_t level, float voltage);
+static uint8_t UpdateBankAlarm(uint8_t bank, float voltage, uint32_t currentTime);
+static void UpdateWarningOutput(void);
+static void UpdateLowVoltageDisconnect(uint32_t currentTime);
+static uint16_t ToMillivolts(float voltage);
 
 /**
   * @brief  Initialize the battery management module
@@ -27,19 +62,41 @@ void BATTERY_Init(void)
   // Initialize GPIO for low battery warning
   // (already done in MX_GPIO_Init())
 
-  // Reset low battery flag
-  batteryLowFlag = 0;
+  // Reset low-voltage alarm state machines
+  for (int i = 0; i < BATTERY_BANK_COUNT; i++) {
+    bankAlarms[i].level = BATTERY_ALARM_NONE;
+    bankAlarms[i].pendingLevel = BATTERY_ALARM_NONE;
+    bankAlarms[i].pendingSince = 0;
+  }
+
+  lvdDisconnected = 0;
+  lvdRecovering = 0;
+  lvdGatingBank = BANK_A;
+  lvdDipping = 0;
 }
 
 /**
   * @brief  Update battery state
+  * @note   Call right after each ADC_ReadAll so the low-voltage disconnect
+  *         acts on the newest sample
   * @retval None
   */
 void BATTERY_Update(void)
 {
-  // This function is called periodically to update battery state
-  // and handle low battery warning
   // The actual voltage measurement is done elsewhere (ADC_ReadAll)
+  uint32_t currentTime = HAL_GetTick();
+  uint8_t changed = 0;
+
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    changed |= UpdateBankAlarm(bank, systemState.voltages[bank], currentTime);
+  }
+
+  // Only touch the warning output when a level actually changed
+  if (changed) {
+    UpdateWarningOutput();
+  }
+
+  UpdateLowVoltageDisconnect(currentTime);
 }
 
 /**
@@ -69,13 +126,6 @@ uint8_t BATTERY_CalculateLevel(float voltage)
   if (level < 0) level = 0;
   if (level > 100) level = 100;
 
-  // Check if battery is low
-  batteryLowFlag = BATTERY_IsLow(voltage);
-
-  // Update warning LED if needed
-  HAL_GPIO_WritePin(WARNING_LOW_VOLTAGE_GPIO_Port, WARNING_LOW_VOLTAGE_Pin,
-                    batteryLowFlag ? GPIO_PIN_SET : GPIO_PIN_RESET);
-
   return (uint8_t)level;
 }
 
@@ -89,3 +139,200 @@ uint8_t BATTERY_IsLow(float voltage)
   // Return 1 if voltage is below low threshold
   return (voltage < BATTERY_LOW_VOLTAGE) ? 1 : 0;
 }
+
+/**
+  * @brief  Get qualified low-voltage alarm level of a bank
+  * @param  bank: BANK_A or BANK_B
+  * @retval Alarm level (BatteryAlarmEnum)
+  */
+uint8_t BATTERY_GetAlarm(uint8_t bank)
+{
+  if (bank >= BATTERY_BANK_COUNT) {
+    return BATTERY_ALARM_NONE;
+  }
+  return bankAlarms[bank].level;
+}
+
+/**
+  * @brief  Check if the low-voltage disconnect holds the output open
+  * @retval 1 if disconnected, 0 otherwise
+  */
+uint8_t BATTERY_IsDisconnected(void)
+{
+  return lvdDisconnected;
+}
+
+/**
+  * @brief  Find the alarm level a voltage points to from the current level
+  * @note   Deeper levels use their set voltage, recovery uses the clear
+  *         voltage of the level being left, which gives the hysteresis band.
+  * @param  level: Current alarm level
+  * @param  voltage: Bank voltage
+  * @retval Target alarm level
+  */
+static uint8_t GetTargetAlarm(uint8_t level, float voltage)
+{
+  uint8_t target = level;
+
+  // Go deeper while voltage is below the next level's set threshold
+  while (target < BATTERY_ALARM_CUTOFF &&
+         voltage < alarmThresholds[target + 1].setVoltage) {
+    target++;
+  }
+
+  // Otherwise recover while voltage is above the current level's clear threshold
+  if (target == level) {
+    while (target > BATTERY_ALARM_NONE &&
+           voltage > alarmThresholds[target].clearVoltage) {
+      target--;
+    }
+  }
+
+  return target;
+}
+
+/**
+  * @brief  Run the low-voltage state machine of one bank
+  * @param  bank: Bank index
+  * @param  voltage: Bank voltage
+  * @param  currentTime: Current tick in ms
+  * @retval 1 if the qualified level changed, 0 otherwise
+  */
+static uint8_t UpdateBankAlarm(uint8_t bank, float voltage, uint32_t currentTime)
+{
+  BankAlarm_t* alarm = &bankAlarms[bank];
+  uint8_t target = GetTargetAlarm(alarm->level, voltage);
+
+  // Voltage back inside the current band: drop any pending transition
+  if (target == alarm->level) {
+    alarm->pendingLevel = alarm->level;
+    return 0;
+  }
+
+  // New candidate level: start its qualification timer
+  if (target != alarm->pendingLevel) {
+    alarm->pendingLevel = target;
+    alarm->pendingSince = currentTime;
+    return 0;
+  }
+
+  uint32_t qualifyTime = (target > alarm->level) ? BATTERY_ALARM_SET_TIME
+                                                 : BATTERY_ALARM_CLEAR_TIME;
+  if (currentTime - alarm->pendingSince < qualifyTime) {
+    return 0;
+  }
+
+  // Qualified transition
+  alarm->level = target;
+  EVENT_Post(EVENT_LOW_VOLTAGE, bank, target);
+  return 1;
+}
+
+/**
+  * @brief  Drive the low-voltage warning output from the bank alarm levels
+  * @retval None
+  */
+static void UpdateWarningOutput(void)
+{
+  uint8_t warning = 0;
+
+  for (int i = 0; i < BATTERY_BANK_COUNT; i++) {
+    if (bankAlarms[i].level >= BATTERY_ALARM_WARNING) {
+      warning = 1;
+    }
+  }
+
+  SYSTEM_SetLED(LED_WARNING, warning);
+}
+
+/**
+  * @brief  Open or release the power output based on bank alarm levels
+  * @param  currentTime: Current tick in ms
+  * @retval None
+  */
+static void UpdateLowVoltageDisconnect(uint32_t currentTime)
+{
+  uint8_t bank;
+
+  if (!lvdDisconnected) {
+    // Disconnect as soon as any bank reaches the qualified cutoff level
+    for (bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+      if (bankAlarms[bank].level == BATTERY_ALARM_CUTOFF) {
+        lvdDisconnected = 1;
+        lvdRecovering = 0;
+        SYSTEM_SetPowerInhibit(INHIBIT_LOW_VOLTAGE, 1);
+        EVENT_Post(EVENT_LVD_DISCONNECT, bank, ToMillivolts(systemState.voltages[bank]));
+        return;
+      }
+    }
+    return;
+  }
+
+  if (!lvdRecovering) {
+    // Every bank must be out of cutoff and above the reconnect voltage
+    for (bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+      if (bankAlarms[bank].level == BATTERY_ALARM_CUTOFF ||
+          systemState.voltages[bank] < BATTERY_RECONNECT_VOLTAGE) {
+        lvdGatingBank = bank;
+        return;
+      }
+    }
+
+    lvdRecovering = 1;
+    lvdRecoverySince = currentTime;
+    lvdDipping = 0;
+    EVENT_Post(EVENT_LVD_HOLDOFF, lvdGatingBank, 1);
+    return;
+  }
+
+  // Back in cutoff aborts at once, a dip below the band only once qualified
+  uint8_t dipping = 0;
+  for (bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    if (bankAlarms[bank].level == BATTERY_ALARM_CUTOFF) {
+      break;
+    }
+    if (systemState.voltages[bank] < BATTERY_RECONNECT_VOLTAGE - BATTERY_RECONNECT_HYSTERESIS) {
+      dipping = 1;
+      if (!lvdDipping) {
+        lvdDipping = 1;
+        lvdDipSince = currentTime;
+      }
+      if (currentTime - lvdDipSince >= BATTERY_RECONNECT_ABORT_TIME) {
+        break;
+      }
+    }
+  }
+
+  if (bank < BATTERY_BANK_COUNT) {
+    lvdRecovering = 0;
+    lvdGatingBank = bank;
+    EVENT_Post(EVENT_LVD_HOLDOFF, bank, 0);
+    return;
+  }
+
+  // Never reconnect in a dip, the holdoff goes on once it is over
+  if (dipping) {
+    return;
+  }
+  lvdDipping = 0;
+
+  if (currentTime - lvdRecoverySince >= BATTERY_RECONNECT_HOLDOFF) {
+    lvdDisconnected = 0;
+    lvdRecovering = 0;
+    SYSTEM_SetPowerInhibit(INHIBIT_LOW_VOLTAGE, 0);
+    EVENT_Post(EVENT_LVD_RECONNECT, lvdGatingBank, ToMillivolts(systemState.voltages[lvdGatingBank]));
+  }
+}
+
+/**
+  * @brief  Convert a voltage to millivolts for event payloads
+  * @param  voltage: Voltage in volts
+  * @retval Voltage in millivolts
+  */
+static uint16_t ToMillivolts(float voltage)
+{
+  if (voltage <= 0.0f) {
+    return 0;
+  }
+  return (uint16_t)(voltage * 1000.0f);
+}
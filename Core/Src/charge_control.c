@@ -0,0 +1,229 @@
+/**
+  ******************************************************************************
+  * @file    charge_control.c
+  * @brief   Charge termination module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "charge_control.h"
+#include "system_control.h"
+#include "battery_management.h"
+#include "event_log.h"
+#include "adc.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* Channels that must all be flat for a plateau */
+static const uint8_t plateauChannels[] = { BANK_A, BANK_B, CHARGE };
+#define PLATEAU_CHANNEL_COUNT (sizeof(plateauChannels) / sizeof(plateauChannels[0]))
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t trackedMode = CHARGE_OFF;   // Charge mode the detector state belongs to
+static uint8_t trackedCommand = CHARGE_OFF; // Commanded mode the charge time belongs to
+static uint32_t chargeTime = 0;            // ms charged in trackedCommand, across inhibits
+static uint32_t lastChargeTick = 0;
+static uint32_t phaseStart = 0;
+static uint32_t lastSlopeTime = 0;
+static float previousMv[PLATEAU_CHANNEL_COUNT];
+static float peakMv[BATTERY_BANK_COUNT];
+static uint8_t flatIntervals = 0;
+static uint8_t lastEnd = CHARGER_END_NONE;
+static uint8_t suspended = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static void StartPhase(uint8_t mode, uint32_t currentTime);
+static void StartChargeTime(uint8_t command, uint32_t currentTime);
+static uint8_t CheckSlope(uint32_t currentTime);
+static void Terminate(uint8_t reason);
+
+/**
+  * @brief  Initialize charge termination detection
+  * @retval None
+  */
+void CHARGER_Init(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+
+  lastEnd = CHARGER_END_NONE;
+  suspended = 0;
+  StartChargeTime(SYSTEM_GetChargeMode(), currentTime);
+  StartPhase(SYSTEM_GetChargeMode(), currentTime);
+}
+
+/**
+  * @brief  Evaluate the termination criteria of the running charge phase
+  * @note   Uses the filtered samples, call after ADC_ReadAll
+  * @retval None
+  */
+void CHARGER_Update(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+  uint8_t command = SYSTEM_GetChargeMode();
+  uint8_t mode = SYSTEM_GetChargeInhibit() ? CHARGE_OFF : command;
+
+  // Only a commanded change restarts the safety count, an inhibit pauses it
+  if (command != trackedCommand) {
+    StartChargeTime(command, currentTime);
+  }
+
+  // A mode change (ours, the PC app or an inhibit) starts a new phase
+  if (mode != trackedMode) {
+    StartPhase(mode, currentTime);
+  }
+
+  if (mode == CHARGE_OFF || suspended) {
+    lastChargeTick = currentTime;
+    return;
+  }
+
+  chargeTime += currentTime - lastChargeTick;
+  lastChargeTick = currentTime;
+
+  uint32_t timeout = (mode == CHARGE_FAST) ? CHARGER_FAST_TIMEOUT : CHARGER_NORMAL_TIMEOUT;
+  if (chargeTime >= timeout) {
+    Terminate(CHARGER_END_TIMEOUT);
+    return;
+  }
+
+  if (currentTime - lastSlopeTime >= CHARGER_SLOPE_INTERVAL) {
+    lastSlopeTime = currentTime;
+    uint8_t reason = CheckSlope(currentTime);
+    if (reason != CHARGER_END_NONE) {
+      Terminate(reason);
+    }
+  }
+}
+
+/**
+  * @brief  Suspend termination detection, e.g. during an equalization charge
+  * @param  suspend: 1 to suspend, 0 to resume with a new phase
+  * @retval None
+  */
+void CHARGER_Suspend(uint8_t suspend)
+{
+  if (suspended && !suspend) {
+    StartPhase(SYSTEM_GetChargeMode(), HAL_GetTick());
+  }
+  suspended = suspend ? 1 : 0;
+}
+
+/**
+  * @brief  Get the reason the last charge phase was terminated
+  * @retval ChargerEndEnum
+  */
+uint8_t CHARGER_GetLastEnd(void)
+{
+  return lastEnd;
+}
+
+/**
+  * @brief  Reset the detector for a new charge phase
+  * @param  mode: Charge mode of the phase
+  * @param  currentTime: Current tick
+  * @retval None
+  */
+static void StartPhase(uint8_t mode, uint32_t currentTime)
+{
+  trackedMode = mode;
+  phaseStart = currentTime;
+  lastSlopeTime = currentTime;
+  flatIntervals = 0;
+
+  for (uint8_t i = 0; i < PLATEAU_CHANNEL_COUNT; i++) {
+    previousMv[i] = ADC_GetFiltered(plateauChannels[i]) * 1000.0f;
+  }
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    peakMv[bank] = ADC_GetFiltered(bank) * 1000.0f;
+  }
+}
+
+/**
+  * @brief  Restart the cumulative charge time for a commanded mode
+  * @param  command: Commanded charge mode
+  * @param  currentTime: Current tick
+  * @retval None
+  */
+static void StartChargeTime(uint8_t command, uint32_t currentTime)
+{
+  trackedCommand = command;
+  chargeTime = 0;
+  lastChargeTick = currentTime;
+}
+
+/**
+  * @brief  Update dV/dt and peak tracking with the filtered samples
+  * @param  currentTime: Current tick
+  * @retval ChargerEndEnum, CHARGER_END_NONE while charging continues
+  */
+static uint8_t CheckSlope(uint32_t currentTime)
+{
+  uint8_t flat = 1;
+  uint8_t dropped = 0;
+
+  for (uint8_t i = 0; i < PLATEAU_CHANNEL_COUNT; i++) {
+    float mv = ADC_GetFiltered(plateauChannels[i]) * 1000.0f;
+    float dv = mv - previousMv[i];
+
+    if (dv > CHARGER_PLATEAU_DV || dv < -CHARGER_PLATEAU_DV) {
+      flat = 0;
+    }
+    previousMv[i] = mv;
+  }
+
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    float mv = ADC_GetFiltered(bank) * 1000.0f;
+
+    if (mv > peakMv[bank]) {
+      peakMv[bank] = mv;
+    } else if (peakMv[bank] - mv >= CHARGER_NEGATIVE_DV) {
+      dropped = 1;
+    }
+  }
+
+  flatIntervals = flat ? flatIntervals + 1 : 0;
+
+  // Give the charger time to raise the voltage before judging the curve
+  if (currentTime - phaseStart < CHARGER_MIN_PHASE_TIME) {
+    return CHARGER_END_NONE;
+  }
+
+#if CHARGER_NEGATIVE_DV_ENABLE
+  if (dropped) {
+    return CHARGER_END_NEGATIVE_DV;
+  }
+#else
+  (void)dropped;
+#endif
+
+  if (flatIntervals >= CHARGER_PLATEAU_INTERVALS) {
+    return CHARGER_END_PLATEAU;
+  }
+
+  return CHARGER_END_NONE;
+}
+
+/**
+  * @brief  End the running phase: fast charge drops to float, float ends charging
+  * @param  reason: ChargerEndEnum
+  * @retval None
+  */
+static void Terminate(uint8_t reason)
+{
+  uint8_t mode = trackedMode;
+  uint8_t next = (mode == CHARGE_FAST) ? CHARGE_NORMAL : CHARGE_OFF;
+
+  uint32_t currentTime = HAL_GetTick();
+
+  lastEnd = reason;
+  SYSTEM_SetChargeMode(next);
+  StartChargeTime(next, currentTime);
+  StartPhase(next, currentTime);
+
+  EVENT_Post(EVENT_CHARGE_TERMINATED, reason, mode);
+}
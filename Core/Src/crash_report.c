@@ -0,0 +1,206 @@
+/**
+  ******************************************************************************
+  * @file    crash_report.c
+  * @brief   Crash capture and post-mortem report module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "crash_report.h"
+#include "system_control.h"
+#include "event_log.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define CRASH_RAM_START     0x20000000UL
+#define CRASH_FRAME_WORDS   8     // r0-r3, r12, lr, pc, xpsr stacked by the core
+#define CRASH_XPSR_ALIGNED  (1UL << 9) // Stack was realigned by 4 bytes on entry
+
+extern uint32_t _estack;    // End of RAM (STM32F103C8TX_FLASH.ld)
+
+/* Private variables ---------------------------------------------------------*/
+static CrashReport_t report __attribute__((section(".noinit")));
+
+/* Private function prototypes -----------------------------------------------*/
+static void CaptureFault(uint32_t* frame) __attribute__((used, noreturn));
+static void SaveAndReset(uint8_t source, uint32_t sp) __attribute__((noreturn));
+static uint8_t IsStackAddress(uint32_t address, uint32_t words);
+static uint32_t ComputeChecksum(void);
+
+/**
+  * @brief  Validate the saved report and journal a new crash
+  * @note   EVENT_Init must have been called
+  * @retval None
+  */
+void CRASH_Init(void)
+{
+  if (report.magic != CRASH_MAGIC || report.checksum != ComputeChecksum()) {
+    CRASH_Clear();
+    return;
+  }
+
+  if (report.pending) {
+    // PC within the 64 KB flash is identified by its low half-word
+    EVENT_Post(EVENT_CRASH, report.source, (uint16_t)report.pc);
+    report.pending = 0;
+    report.checksum = ComputeChecksum();
+  }
+}
+
+/**
+  * @brief  Get the saved crash report
+  * @retval Pointer to the report, NULL if there is none
+  */
+const CrashReport_t* CRASH_GetReport(void)
+{
+  return report.count > 0 ? &report : NULL;
+}
+
+/**
+  * @brief  Discard the saved crash report
+  * @retval None
+  */
+void CRASH_Clear(void)
+{
+  uint32_t* raw = (uint32_t*)&report;
+  for (uint16_t i = 0; i < sizeof(report) / sizeof(uint32_t); i++) {
+    raw[i] = 0;
+  }
+  report.magic = CRASH_MAGIC;
+  report.checksum = ComputeChecksum();
+}
+
+/**
+  * @brief  Save a report for a fatal software error, drive outputs off and reset
+  * @param  caller: Return address of Error_Handler
+  * @retval None (does not return)
+  */
+void CRASH_FromError(uint32_t caller)
+{
+  __disable_irq();
+
+  report.frameValid = 0;
+  report.r0 = report.r1 = report.r2 = report.r3 = report.r12 = 0;
+  report.lr = caller;
+  report.pc = caller;
+  report.xpsr = __get_xPSR();
+
+  SaveAndReset(CRASH_SOURCE_ERROR, __get_MSP());
+}
+
+/**
+  * @brief  HardFault exception entry
+  * @note   Naked so the stack pointer is read before any compiler prologue;
+  *         EXC_RETURN bit 2 selects the stack the core pushed the frame on.
+  * @retval None (does not return)
+  */
+__attribute__((naked)) void HardFault_Handler(void)
+{
+  __asm volatile(
+    "  tst   lr, #4        \n"
+    "  ite   eq            \n"
+    "  mrseq r0, msp       \n"
+    "  mrsne r0, psp       \n"
+    "  b     CaptureFault  \n");
+}
+
+/**
+  * @brief  Copy the exception frame and save the report
+  * @param  frame: Stack pointer holding the exception frame
+  * @retval None (does not return)
+  */
+static void CaptureFault(uint32_t* frame)
+{
+  uint32_t sp = (uint32_t)frame;
+
+  // A corrupt stack pointer would fault again (lockup), only read RAM
+  report.frameValid = IsStackAddress(sp, CRASH_FRAME_WORDS);
+  if (report.frameValid) {
+    report.r0 = frame[0];
+    report.r1 = frame[1];
+    report.r2 = frame[2];
+    report.r3 = frame[3];
+    report.r12 = frame[4];
+    report.lr = frame[5];
+    report.pc = frame[6];
+    report.xpsr = frame[7];
+
+    sp += CRASH_FRAME_WORDS * sizeof(uint32_t);
+    if (report.xpsr & CRASH_XPSR_ALIGNED) {
+      sp += sizeof(uint32_t);
+    }
+  }
+
+  SaveAndReset(CRASH_SOURCE_HARDFAULT, sp);
+}
+
+/**
+  * @brief  Complete the report, drive outputs off and reset
+  * @param  source: Crash source (CrashSourceEnum)
+  * @param  sp: Stack pointer of the crashed code
+  * @retval None (does not return)
+  */
+static void SaveAndReset(uint8_t source, uint32_t sp)
+{
+  // Outputs first, the rest only costs time with the enables already off
+  SYSTEM_ForceSafeOutputs();
+
+  // Keep the crash count of a report that survived the last reset
+  if (report.magic != CRASH_MAGIC || report.checksum != ComputeChecksum()) {
+    report.count = 0;
+  }
+
+  report.magic = CRASH_MAGIC;
+  report.count++;
+  report.source = source;
+  report.pending = 1;
+  report.reserved = 0;
+  report.tick = HAL_GetTick();
+  report.cfsr = SCB->CFSR;
+  report.hfsr = SCB->HFSR;
+  report.bfar = SCB->BFAR;
+  report.mmfar = SCB->MMFAR;
+  report.sp = sp;
+
+  for (uint8_t i = 0; i < CRASH_STACK_WORDS; i++) {
+    uint32_t address = sp + i * sizeof(uint32_t);
+    report.stack[i] = IsStackAddress(address, 1) ? *(uint32_t*)address : 0;
+  }
+
+  report.checksum = ComputeChecksum();
+
+  NVIC_SystemReset();
+}
+
+/**
+  * @brief  Check that a word range lies in RAM and is aligned
+  * @param  address: Start address
+  * @param  words: Number of words
+  * @retval 1 if readable, 0 otherwise
+  */
+static uint8_t IsStackAddress(uint32_t address, uint32_t words)
+{
+  return (address & 0x3) == 0 &&
+         address >= CRASH_RAM_START &&
+         address + words * sizeof(uint32_t) <= (uint32_t)&_estack;
+}
+
+/**
+  * @brief  Compute the report checksum
+  * @retval Inverted sum of all report words before the checksum
+  */
+static uint32_t ComputeChecksum(void)
+{
+  const uint32_t* raw = (const uint32_t*)&report;
+  uint32_t sum = 0;
+
+  for (uint16_t i = 0; i < offsetof(CrashReport_t, checksum) / sizeof(uint32_t); i++) {
+    sum += raw[i];
+  }
+  return ~sum;
+}
@@ -0,0 +1,234 @@
+/**
+  ******************************************************************************
+  * @file    equalize.c
+  * @brief   Equalization charge scheduler module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "equalize.h"
+#include "system_control.h"
+#include "battery_management.h"
+#include "fault_handling.h"
+#include "charge_control.h"
+#include "state_machine.h"
+#include "lifetime_stats.h"
+#include "nvm_storage.h"
+#include "event_log.h"
+
+/* Private variables ---------------------------------------------------------*/
+static EqualizeStatus_t status;
+static uint8_t requested = 0;        // Manual start requested over USB
+static uint8_t resumeMode = CHARGE_NORMAL; // Charge mode restored after the run
+static uint32_t lastUpdateTime = 0;
+static uint32_t startTime = 0;       // Tick the running equalization started
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t IsDue(void);
+static uint8_t CheckConditions(void);
+static void Start(uint32_t currentTime);
+static void Finish(uint8_t outcome);
+
+/**
+  * @brief  Initialize the scheduler and restore its record from flash
+  * @note   NVM_Init and LIFETIME_Init must have been called
+  * @retval None
+  */
+void EQUALIZE_Init(void)
+{
+  if (!NVM_Read(NVM_TAG_EQUALIZE, &status.record, sizeof(status.record))) {
+    // Never equalized: count the interval from the current operating time
+    status.record.lastRunSeconds = LIFETIME_GetOperatingSeconds();
+    status.record.cycles = 0;
+    status.record.lastOutcome = EQUALIZE_OUTCOME_NONE;
+    status.record.reserved = 0;
+  }
+
+  status.phase = EQUALIZE_IDLE;
+  status.waiting = EQUALIZE_OUTCOME_NONE;
+  status.elapsed = 0;
+  requested = 0;
+  lastUpdateTime = HAL_GetTick();
+}
+
+/**
+  * @brief  Start a due equalization when safe and supervise a running one
+  * @retval None
+  */
+void EQUALIZE_Update(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+
+  if (currentTime - lastUpdateTime < EQUALIZE_UPDATE_INTERVAL) {
+    return;
+  }
+  lastUpdateTime = currentTime;
+
+  switch (status.phase) {
+  case EQUALIZE_IDLE:
+    if (requested || IsDue()) {
+      status.phase = EQUALIZE_PENDING;
+    }
+    break;
+
+  case EQUALIZE_PENDING:
+    // The reason the start is held is kept for the status report
+    status.waiting = CheckConditions();
+    if (status.waiting == EQUALIZE_OUTCOME_NONE) {
+      Start(currentTime);
+    }
+    break;
+
+  case EQUALIZE_RUNNING: {
+    // Steps may come late, the duration is measured on the tick
+    status.elapsed = (currentTime - startTime) / 1000;
+
+    uint8_t outcome = CheckConditions();
+
+    // Anything else changing the charge mode ends the run
+    if (outcome == EQUALIZE_OUTCOME_NONE && SYSTEM_GetChargeMode() != CHARGE_FAST) {
+      outcome = EQUALIZE_OUTCOME_USER;
+    }
+
+    if (outcome == EQUALIZE_OUTCOME_NONE && status.elapsed >= EQUALIZE_DURATION) {
+      outcome = EQUALIZE_OUTCOME_COMPLETE;
+    }
+
+    if (outcome != EQUALIZE_OUTCOME_NONE) {
+      Finish(outcome);
+    }
+    break;
+  }
+
+  default:
+    status.phase = EQUALIZE_IDLE;
+    break;
+  }
+}
+
+/**
+  * @brief  Request an equalization now or abort the pending/running one
+  * @param  start: 1 to request, 0 to abort
+  * @retval None
+  */
+void EQUALIZE_Request(uint8_t start)
+{
+  if (start) {
+    requested = 1;
+    return;
+  }
+
+  requested = 0;
+  if (status.phase != EQUALIZE_IDLE) {
+    Finish(EQUALIZE_OUTCOME_USER);
+  }
+}
+
+/**
+  * @brief  Get scheduler status
+  * @retval Pointer to the status
+  */
+const EqualizeStatus_t* EQUALIZE_GetStatus(void)
+{
+  return &status;
+}
+
+/**
+  * @brief  Check whether the equalization interval has passed
+  * @retval 1 if due
+  */
+static uint8_t IsDue(void)
+{
+  return LIFETIME_GetOperatingSeconds() - status.record.lastRunSeconds >= EQUALIZE_INTERVAL;
+}
+
+/**
+  * @brief  Check the conditions for starting or continuing an equalization
+  * @retval EQUALIZE_OUTCOME_NONE when safe, otherwise the abort reason
+  */
+static uint8_t CheckConditions(void)
+{
+  if (FAULT_GetState() != FAULT_NONE) {
+    return EQUALIZE_OUTCOME_FAULT;
+  }
+
+  if (systemState.voltages[CHARGE] <= STATE_CHARGER_PRESENT_VOLTAGE) {
+    return EQUALIZE_OUTCOME_NO_CHARGER;
+  }
+
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    float voltage = systemState.voltages[bank];
+
+    if (voltage > EQUALIZE_MAX_VOLTAGE) {
+      return EQUALIZE_OUTCOME_OVERVOLTAGE;
+    }
+    // Only a charged bank is equalized; once running the bank is above this anyway
+    if (status.phase == EQUALIZE_PENDING && voltage <= EQUALIZE_START_VOLTAGE) {
+      return EQUALIZE_OUTCOME_LOW_BANK;
+    }
+  }
+
+  return EQUALIZE_OUTCOME_NONE;
+}
+
+/**
+  * @brief  Switch the charger to the equalization charge
+  * @param  currentTime: Current HAL tick
+  * @retval None
+  */
+static void Start(uint32_t currentTime)
+{
+  uint8_t mode = SYSTEM_GetChargeMode();
+
+  resumeMode = (mode == CHARGE_OFF) ? CHARGE_NORMAL : mode;
+  requested = 0;
+  status.phase = EQUALIZE_RUNNING;
+  status.waiting = EQUALIZE_OUTCOME_NONE;
+  status.elapsed = 0;
+  startTime = currentTime;
+
+  // The overcharge is intended, keep termination detection out of the way
+  CHARGER_Suspend(1);
+  SYSTEM_SetChargeMode(CHARGE_FAST);
+
+  EVENT_Post(EVENT_EQUALIZE, EQUALIZE_OUTCOME_NONE, status.record.cycles);
+}
+
+/**
+  * @brief  End the pending or running equalization and store the outcome
+  * @param  outcome: EqualizeOutcomeEnum
+  * @retval None
+  */
+static void Finish(uint8_t outcome)
+{
+  if (status.phase == EQUALIZE_RUNNING) {
+    // A user abort leaves the charge mode to the user
+    if (outcome != EQUALIZE_OUTCOME_USER) {
+      SYSTEM_SetChargeMode(outcome == EQUALIZE_OUTCOME_COMPLETE ? resumeMode : CHARGE_OFF);
+    }
+    CHARGER_Suspend(0);
+  }
+
+  status.phase = EQUALIZE_IDLE;
+  status.waiting = EQUALIZE_OUTCOME_NONE;
+  status.record.lastOutcome = outcome;
+
+  if (outcome == EQUALIZE_OUTCOME_COMPLETE) {
+    status.record.cycles++;
+  }
+  // Completed or skipped by the user: next one is due a full interval later
+  if (outcome == EQUALIZE_OUTCOME_COMPLETE || outcome == EQUALIZE_OUTCOME_USER) {
+    status.record.lastRunSeconds = LIFETIME_GetOperatingSeconds();
+  }
+
+  EVENT_Post(EVENT_EQUALIZE, outcome, (uint16_t)status.elapsed);
+
+  // One write per run; an aborted run stays due and retries when safe
+  NVM_Write(NVM_TAG_EQUALIZE, &status.record, sizeof(status.record));
+}
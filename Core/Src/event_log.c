@@ -0,0 +1,435 @@
+/**
+  ******************************************************************************
+  * @file    event_log.c
+  * @brief   Event log module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  *
+  * The flash journal is a ring of JournalRecord_t slots over NVM_JOURNAL_PAGES
+  * pages. A slot is free when erased, valid when its checksum matches, and a
+  * torn write otherwise (skipped). At startup the valid record with the
+  * highest sequence number marks the write position. The page following the
+  * one being filled is kept erased, so the oldest page is dropped as a whole.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "event_log.h"
+#include "nvm_storage.h"
+#include "fault_handling.h"
+#include "lifetime_stats.h"
+#include "scheduler.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define JOURNAL_RECORD_SIZE    sizeof(JournalRecord_t)
+#define JOURNAL_END            (NVM_JOURNAL_BASE + NVM_JOURNAL_PAGES * FLASH_PAGE_SIZE)
+#define JOURNAL_SLOTS          ((NVM_JOURNAL_PAGES * FLASH_PAGE_SIZE) / JOURNAL_RECORD_SIZE)
+#define JOURNAL_RECORD_HALFWORDS (JOURNAL_RECORD_SIZE / 2)
+
+/* Private variables ---------------------------------------------------------*/
+static Event_t eventLog[EVENT_LOG_SIZE];
+static uint8_t eventHead = 0;  // Next slot to write
+static uint8_t eventCount = 0; // Number of valid events
+
+static JournalRecord_t journalQueue[EVENT_JOURNAL_QUEUE];
+static uint8_t queueHead = 0;       // Record being programmed
+static uint8_t queueCount = 0;
+static uint8_t programIndex = 0;    // Half-words of the head record programmed
+static uint32_t writeAddress = NVM_JOURNAL_BASE; // Next slot to program
+static uint32_t eraseAddress = 0;   // Page to erase ahead, 0 if none
+static uint8_t clearPages = 0;      // Pages left to erase for a clear
+static uint32_t nextSequence = 0;
+static uint16_t journalCount = 0;
+static uint32_t journalDropped = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static void QueueRecord(const Event_t* event);
+static uint32_t RecordChecksum(const JournalRecord_t* record);
+static uint8_t IsRecordValid(uint32_t address);
+static uint8_t IsErased(uint32_t address, uint32_t length);
+static uint32_t NextSlot(uint32_t address);
+static void ErasePage(uint32_t address);
+static void JournalStep(void);
+static void ProgramStep(void);
+
+/**
+  * @brief  Initialize the event log module
+  * @retval None
+  */
+void EVENT_Init(void)
+{
+  uint32_t newestAddress = 0;
+  uint32_t newestSequence = 0;
+
+  eventHead = 0;
+  eventCount = 0;
+  queueHead = 0;
+  queueCount = 0;
+  programIndex = 0;
+  eraseAddress = 0;
+  clearPages = 0;
+  journalCount = 0;
+  journalDropped = 0;
+
+  // Locate the newest record, the ring continues behind it
+  for (uint32_t address = NVM_JOURNAL_BASE; address < JOURNAL_END; address += JOURNAL_RECORD_SIZE) {
+    if (!IsRecordValid(address)) {
+      continue;
+    }
+
+    uint32_t sequence = ((const JournalRecord_t*)address)->sequence;
+    if (newestAddress == 0 || (int32_t)(sequence - newestSequence) > 0) {
+      newestAddress = address;
+      newestSequence = sequence;
+    }
+    journalCount++;
+  }
+
+  if (newestAddress != 0) {
+    writeAddress = NextSlot(newestAddress);
+    nextSequence = newestSequence + 1;
+  } else {
+    writeAddress = NVM_JOURNAL_BASE;
+    nextSequence = 0;
+  }
+}
+
+/**
+  * @brief  Record an event
+  * @param  type: Event type (EventTypeEnum)
+  * @param  source: Event source
+  * @param  data: Event payload
+  * @retval None
+  */
+void EVENT_Post(uint8_t type, uint8_t source, uint16_t data)
+{
+  uint32_t key = SCHED_Lock();
+  Event_t* event = &eventLog[eventHead];
+
+  event->timestamp = HAL_GetTick();
+  event->type = type;
+  event->source = source;
+  event->data = data;
+
+  QueueRecord(event);
+
+  // Advance write position, overwriting the oldest event when full
+  eventHead = (eventHead + 1) % EVENT_LOG_SIZE;
+  if (eventCount < EVENT_LOG_SIZE) {
+    eventCount++;
+  }
+  SCHED_Unlock(key);
+}
+
+/**
+  * @brief  Get number of events currently held in the log
+  * @retval Number of events
+  */
+uint8_t EVENT_GetCount(void)
+{
+  return eventCount;
+}
+
+/**
+  * @brief  Read an event from the log
+  * @param  index: Event index (0 = oldest)
+  * @param  event: Pointer to store the event
+  * @retval 1 if the event exists, 0 otherwise
+  */
+uint8_t EVENT_Get(uint8_t index, Event_t* event)
+{
+  if (index >= eventCount) {
+    return 0;
+  }
+
+  // Oldest event sits eventCount slots behind the write position
+  uint32_t key = SCHED_Lock();
+  uint8_t slot = (eventHead + EVENT_LOG_SIZE - eventCount + index) % EVENT_LOG_SIZE;
+  *event = eventLog[slot];
+  SCHED_Unlock(key);
+  return 1;
+}
+
+/**
+  * @brief  Perform one bounded step of journal programming or erasing
+  * @retval None
+  */
+void EVENT_Update(void)
+{
+  // Events are posted from both scheduler levels; flash fetches stall
+  // during the step anyway, so the lock adds no latency of its own
+  uint32_t key = SCHED_Lock();
+  JournalStep();
+  SCHED_Unlock(key);
+}
+
+/**
+  * @brief  Get number of records held in the flash journal
+  * @retval Number of records
+  */
+uint16_t EVENT_GetJournalCount(void)
+{
+  return journalCount;
+}
+
+/**
+  * @brief  Get number of records lost because the journal queue was full
+  * @retval Number of records
+  */
+uint32_t EVENT_GetJournalDropped(void)
+{
+  return journalDropped;
+}
+
+/**
+  * @brief  Read a record from the flash journal
+  * @param  index: Record index (0 = oldest)
+  * @param  record: Pointer to store the record
+  * @retval 1 if the record exists, 0 otherwise
+  */
+uint8_t EVENT_GetJournal(uint16_t index, JournalRecord_t* record)
+{
+  uint32_t address = writeAddress;
+
+  if (index >= journalCount || clearPages > 0) {
+    return 0;
+  }
+
+  // Oldest record is the first valid slot behind the write position
+  for (uint16_t i = 0; i < JOURNAL_SLOTS; i++) {
+    if (IsRecordValid(address)) {
+      if (index == 0) {
+        *record = *(const JournalRecord_t*)address;
+        return 1;
+      }
+      index--;
+    }
+    address = NextSlot(address);
+  }
+
+  return 0;
+}
+
+/**
+  * @brief  Erase the flash journal (performed in steps by EVENT_Update)
+  * @retval None
+  */
+void EVENT_ClearJournal(void)
+{
+  clearPages = NVM_JOURNAL_PAGES;
+  eraseAddress = 0;
+  programIndex = 0;
+  journalCount = 0;
+}
+
+/**
+  * @brief  Snapshot the system around an event into the journal queue
+  * @param  event: Event just posted
+  * @retval None
+  */
+static void QueueRecord(const Event_t* event)
+{
+  if (queueCount >= EVENT_JOURNAL_QUEUE) {
+    journalDropped++;
+    return;
+  }
+
+  JournalRecord_t* record = &journalQueue[(queueHead + queueCount) % EVENT_JOURNAL_QUEUE];
+
+  record->timestamp = event->timestamp;
+  record->operatingSeconds = LIFETIME_GetOperatingSeconds();
+  record->type = event->type;
+  record->source = event->source;
+  record->data = event->data;
+  record->faults = FAULT_GetState();
+  record->state = systemState.state;
+  record->reserved = 0xFFFF;
+  for (uint8_t i = 0; i < VOLTAGE_COUNT; i++) {
+    float mv = systemState.voltages[i] * 1000.0f;
+    record->voltages[i] = (mv > 0.0f) ? (uint16_t)mv : 0;
+  }
+
+  queueCount++;
+}
+
+/**
+  * @brief  Inverted 32-bit sum of every word but the checksum
+  * @param  record: Record to check
+  * @retval Checksum value
+  */
+static uint32_t RecordChecksum(const JournalRecord_t* record)
+{
+  const uint32_t* words = (const uint32_t*)record;
+  uint32_t sum = 0;
+
+  for (uint8_t i = 0; i < JOURNAL_RECORD_SIZE / 4 - 1; i++) {
+    sum += words[i];
+  }
+  return ~sum;
+}
+
+/**
+  * @brief  Check whether a journal slot holds a complete record
+  * @param  address: Slot address
+  * @retval 1 if the checksum matches
+  */
+static uint8_t IsRecordValid(uint32_t address)
+{
+  const JournalRecord_t* record = (const JournalRecord_t*)address;
+  return record->checksum == RecordChecksum(record);
+}
+
+/**
+  * @brief  Check whether a flash range is erased
+  * @param  address: Start address (word aligned)
+  * @param  length: Length in bytes (multiple of 4)
+  * @retval 1 if every word reads 0xFFFFFFFF
+  */
+static uint8_t IsErased(uint32_t address, uint32_t length)
+{
+  for (uint32_t offset = 0; offset < length; offset += 4) {
+    if (*(volatile uint32_t*)(address + offset) != 0xFFFFFFFFUL) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Address of the slot after a slot, wrapping around the journal
+  * @param  address: Slot address
+  * @retval Next slot address
+  */
+static uint32_t NextSlot(uint32_t address)
+{
+  address += JOURNAL_RECORD_SIZE;
+  return (address >= JOURNAL_END) ? NVM_JOURNAL_BASE : address;
+}
+
+/**
+  * @brief  Erase one journal page and forget the records it held
+  * @param  address: Page address
+  * @retval None
+  */
+static void ErasePage(uint32_t address)
+{
+  FLASH_EraseInitTypeDef eraseInit = {0};
+  uint32_t pageError = 0;
+
+  for (uint32_t slot = address; slot < address + FLASH_PAGE_SIZE; slot += JOURNAL_RECORD_SIZE) {
+    if (journalCount > 0 && IsRecordValid(slot)) {
+      journalCount--;
+    }
+  }
+
+  eraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
+  eraseInit.PageAddress = address;
+  eraseInit.NbPages = 1;
+
+  HAL_FLASH_Unlock();
+  HAL_FLASHEx_Erase(&eraseInit, &pageError);
+  HAL_FLASH_Lock();
+}
+
+/**
+  * @brief  Program or erase one bounded step of the journal
+  * @note   Caller holds the scheduler lock
+  * @retval None
+  */
+static void JournalStep(void)
+{
+  // A clear erases one page per step, newest records wait in the queue
+  if (clearPages > 0) {
+    clearPages--;
+    ErasePage(NVM_JOURNAL_BASE + clearPages * FLASH_PAGE_SIZE);
+    if (clearPages == 0) {
+      writeAddress = NVM_JOURNAL_BASE;
+      journalCount = 0;
+    }
+    return;
+  }
+
+  if (eraseAddress != 0) {
+    ErasePage(eraseAddress);
+    eraseAddress = 0;
+    return;
+  }
+
+  if (queueCount == 0) {
+    return;
+  }
+
+  if (programIndex == 0) {
+    if (!IsErased(writeAddress, JOURNAL_RECORD_SIZE)) {
+      if ((writeAddress - NVM_JOURNAL_BASE) % FLASH_PAGE_SIZE == 0) {
+        // Page was not erased ahead (first use or interrupted erase)
+        ErasePage(writeAddress);
+      } else {
+        // Torn record from a reset during programming
+        writeAddress = NextSlot(writeAddress);
+      }
+      return;
+    }
+
+    JournalRecord_t* record = &journalQueue[queueHead];
+    record->sequence = nextSequence++;
+    record->checksum = RecordChecksum(record);
+  }
+
+  ProgramStep();
+}
+
+/**
+  * @brief  Program the next EVENT_JOURNAL_STEP half-words of the head record
+  * @retval None
+  */
+static void ProgramStep(void)
+{
+  const uint16_t* halfWords = (const uint16_t*)&journalQueue[queueHead];
+  uint8_t end = programIndex + EVENT_JOURNAL_STEP;
+
+  if (end > JOURNAL_RECORD_HALFWORDS) {
+    end = JOURNAL_RECORD_HALFWORDS;
+  }
+
+  HAL_FLASH_Unlock();
+  for (; programIndex < end; programIndex++) {
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, writeAddress + programIndex * 2,
+                          halfWords[programIndex]) != HAL_OK) {
+      // Leave the torn slot behind, the record starts over in the next one
+      programIndex = 0;
+      writeAddress = NextSlot(writeAddress);
+      break;
+    }
+  }
+  HAL_FLASH_Lock();
+
+  if (programIndex < JOURNAL_RECORD_HALFWORDS) {
+    return;
+  }
+
+  // Record complete
+  uint32_t recordAddress = writeAddress;
+  programIndex = 0;
+  queueHead = (queueHead + 1) % EVENT_JOURNAL_QUEUE;
+  queueCount--;
+  journalCount++;
+  writeAddress = NextSlot(writeAddress);
+
+  // First record of a page: erase the following page ahead of time
+  if ((recordAddress - NVM_JOURNAL_BASE) % FLASH_PAGE_SIZE == 0) {
+    uint32_t nextPage = recordAddress + FLASH_PAGE_SIZE;
+    if (nextPage >= JOURNAL_END) {
+      nextPage = NVM_JOURNAL_BASE;
+    }
+    if (!IsErased(nextPage, FLASH_PAGE_SIZE)) {
+      eraseAddress = nextPage;
+    }
+  }
+}
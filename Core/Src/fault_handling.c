@@ -14,104 +14,274 @@
 /* Includes ------------------------------------------------------------------*/
 #include "fault_handling.h"
 #include "system_control.h"
+#include "event_log.h"
+#include "lifetime_stats.h"
+#include "nvm_storage.h"
+#include "latch_relay.h"
+#include "adc.h"
+#include "scheduler.h"
 #include "gpio.h"
 
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+  uint8_t fault;          // FaultStateEnum bit
+  GPIO_TypeDef* port;     // FLT_* port
+  uint16_t extiLine;      // FLT_* pin, equal to its EXTI line mask
+  uint16_t cutoffA;       // GPIOA enables cleared on this fault, 0 to disable cutoff
+  uint16_t cutoffB;       // GPIOB enables cleared on this fault, 0 to disable cutoff
+} FaultLine_t;
+
+typedef enum {
+  FAULT_POLICY_LATCH = 0, // Stay faulted until FAULT_ClearLatched
+  FAULT_POLICY_RETRY      // Clear automatically with exponential backoff
+} FaultPolicyEnum;
+
+typedef struct {
+  uint8_t policy;         // FaultPolicyEnum
+  uint8_t retryLimit;     // Automatic clears before latching
+  uint32_t holdTime;      // ms the line must stay HIGH before the first clear
+  uint32_t maxHoldTime;   // Upper bound of the doubled hold time
+} FaultPolicy_t;
+
+typedef enum {
+  LINE_IDLE = 0,          // HIGH, no fault
+  LINE_PENDING,           // Went LOW, waiting for the minimum pulse width
+  LINE_ASSERTED,          // Qualified LOW, fault latched
+  LINE_RELEASED,          // HIGH again, waiting for the hold time
+  LINE_LOCKED             // HIGH, waiting for a commanded clear
+} LineStateEnum;
+
+typedef struct {
+  uint8_t state;          // LineStateEnum
+  uint8_t prevState;      // State the pending pulse started from, restored on a glitch
+  uint8_t low;            // Level after the last edge, 1 = LOW (asserted)
+  uint8_t latched;        // Fault latched on the interrupt side
+  uint8_t retries;        // Automatic clears since clearTick was quiet
+  uint32_t edgeCycles;    // DWT time of the last edge
+  uint32_t edgeTick;      // HAL tick of the last edge
+  uint32_t startCycles;   // DWT time the pulse started
+  uint32_t startTick;     // HAL tick the pulse started
+  uint32_t releaseTick;   // HAL tick the qualified pulse ended
+  uint32_t clearTick;     // HAL tick of the last clear
+} LineState_t;
+
+/* Private constants ---------------------------------------------------------*/
+/* Per-line configuration, in fault bit order. Not const: the cutoff reads it
+ * and must not wait on a flash erase, so it is kept in RAM with the code */
+static FaultLine_t faultLines[FAULT_LINE_COUNT] = {
+  { FAULT_BLOCK_200A,  FLT_BLOCK_200A_GPIO_Port,  FLT_BLOCK_200A_Pin,  EN_BLOCK_100A_Pin,                  EN_BLOCK_200A_Pin },
+  { FAULT_BLOCK_100A,  FLT_BLOCK_100A_GPIO_Port,  FLT_BLOCK_100A_Pin,  EN_BLOCK_100A_Pin,                  EN_BLOCK_200A_Pin },
+  { FAULT_CHARGE,      FLT_CHARGE_GPIO_Port,      FLT_CHARGE_Pin,      EN_CHARGE_Pin | EN_FAST_CHARGE_Pin, 0 },
+  { FAULT_FAST_CHARGE, FLT_FAST_CHARGE_GPIO_Port, FLT_FAST_CHARGE_Pin, EN_CHARGE_Pin | EN_FAST_CHARGE_Pin, 0 },
+};
+
+/* Per-line recovery policy, in fault bit order */
+static const FaultPolicy_t faultPolicies[FAULT_LINE_COUNT] = {
+  { FAULT_POLICY_LATCH, 0, 3000, 3000 },  // BLOCK_200A: never re-enabled automatically
+  { FAULT_POLICY_RETRY, 3, 2000, 30000 }, // BLOCK_100A
+  { FAULT_POLICY_RETRY, 5, 500,  16000 }, // CHARGE: charger transients
+  { FAULT_POLICY_RETRY, 5, 500,  16000 }, // FAST_CHARGE
+};
+
 /* Private variables ---------------------------------------------------------*/
+/* Main loop side */
 static uint8_t faultState = FAULT_NONE;
-static uint32_t faultTimestamps[4] = {0}; // Timestamps for each fault bit
+static FaultHistory_t history;
+static Timestamp_t assertTimes[FAULT_LINE_COUNT]; // Start of the last pulse, valid in assertSeen
+static uint8_t assertSeen = 0;                   // Line bits with a pulse since boot
+static uint8_t historyDirty = 0;
+static uint32_t lastFlushTime = 0;
+static FaultSnapshots_t snapshots;
+static uint8_t snapshotDirty = 0;          // Latest snapshot not persisted yet
+static uint32_t lastSnapshotWrite = 0;
+
+/* Interrupt side */
+static LineState_t lineStates[FAULT_LINE_COUNT];
+static FaultLineStats_t lineStats[FAULT_LINE_COUNT];
+static volatile uint16_t blockedA = 0;    // Enables held off while their line is not idle
+static volatile uint16_t blockedB = 0;
+static volatile uint8_t latchedLines = 0; // Fault bits latched, for resync after overflow
+static volatile uint8_t lockedLines = 0;  // Fault bits waiting for a commanded clear
+static volatile uint8_t clearRequest = 0; // Set by the main loop, taken by SysTick
+static uint32_t isrEntryCycles = 0;       // Entry time of the running EXTI handler
+static uint32_t cyclesPerUs = 1;
+
+/* Vector table copy in RAM, aligned to its size rounded up to a power of two */
+extern const uint32_t g_pfnVectors[];
+static uint32_t ramVectors[16 + USBWakeUp_IRQn + 1] __attribute__((aligned(256)));
+
+/* Event queue: SysTick is the producer, FAULT_Check the consumer */
+static FaultQueue_t eventQueue;
+
+/* Private function prototypes -----------------------------------------------*/
+static void QualifyLine(uint8_t line, uint32_t currentCycles, uint32_t currentTime);
+static void ReleaseLine(uint8_t line, uint32_t currentTime);
+static void ClearLine(uint8_t line, uint32_t currentTime);
+static void PushEvent(uint8_t fault, uint8_t type, Timestamp_t time, uint32_t widthUs);
+static uint32_t PulseWidthUs(const LineState_t* ls, uint32_t endCycles, uint32_t endTick);
+static void UpdateBlockedOutputs(void);
+static void RecordAssert(uint8_t line, Timestamp_t time);
+static void RecordRelease(uint8_t line, Timestamp_t time);
+static void UpdateHistoryHour(void);
+static void TakeSnapshot(uint8_t fault);
+static uint8_t LineIndex(uint8_t fault);
+static void RelocateVectors(void);
 
 /**
   * @brief  Initialize the fault handling module
+  * @note   Lines already LOW are qualified like a fresh edge; NVM_Init
+  *         must have been called (history)
   * @retval None
   */
 void FAULT_Init(void)
 {
-  // Initialize fault state
+  uint8_t* raw = (uint8_t*)lineStats;
+  for (uint16_t i = 0; i < sizeof(lineStats); i++) {
+    raw[i] = 0;
+  }
+
+  RelocateVectors();
+
+  // DWT cycle counter is started by TIMEBASE_Init
+  cyclesPerUs = SystemCoreClock / 1000000;
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
   faultState = FAULT_NONE;
+  latchedLines = 0;
+  lockedLines = 0;
+  clearRequest = 0;
+  FAULT_QueueInit(&eventQueue);
+
+  uint32_t currentTime = HAL_GetTick();
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    LineState_t* ls = &lineStates[i];
 
-  // Clear fault timestamps
-  for (int i = 0; i < 4; i++) {
-    faultTimestamps[i] = 0;
+    ls->low = (faultLines[i].port->IDR & faultLines[i].extiLine) ? 0 : 1;
+    ls->state = ls->low ? LINE_PENDING : LINE_IDLE;
+    ls->prevState = LINE_IDLE;
+    ls->latched = 0;
+    ls->retries = 0;
+    ls->clearTick = currentTime;
+    ls->edgeCycles = DWT->CYCCNT;
+    ls->edgeTick = currentTime;
+    ls->startCycles = ls->edgeCycles;
+    ls->startTick = currentTime;
+    ls->releaseTick = currentTime;
+  }
+
+  UpdateBlockedOutputs();
+  __set_PRIMASK(primask);
+
+  if (!NVM_Read(NVM_TAG_FAULT_HISTORY, &history, sizeof(history))) {
+    uint8_t* rawHistory = (uint8_t*)&history;
+    for (uint16_t i = 0; i < sizeof(history); i++) {
+      rawHistory[i] = 0;
+    }
+  }
+  assertSeen = 0;
+  historyDirty = 0;
+  lastFlushTime = currentTime;
+  snapshots.head = 0;
+  snapshots.count = 0;
+  snapshotDirty = 0;
+  lastSnapshotWrite = currentTime - FAULT_SNAPSHOT_PERSIST_INTERVAL;
+
+  // The snapshot persisted before the reset comes back as the oldest entry
+  if (NVM_Read(NVM_TAG_FAULT_SNAPSHOT, &snapshots.entries[0], sizeof(FaultSnapshot_t))) {
+    snapshots.entries[0].restored = 1;
+    snapshots.head = 1;
+    snapshots.count = 1;
   }
 }
 
 /**
-  * @brief  Check for faults
+  * @brief  Drain the fault event queue and update the fault state
+  * @note   Preempting scheduler level only
   * @retval None
   */
 void FAULT_Check(void)
 {
-  uint8_t currentFaults = FAULT_NONE;
-  uint32_t currentTime = HAL_GetTick();
+  FaultEvent_t event;
 
-  // Check BLOCK_200A fault line (PB1)
-  if (HAL_GPIO_ReadPin(FLT_BLOCK_200A_GPIO_Port, FLT_BLOCK_200A_Pin) == GPIO_PIN_RESET) {
-    currentFaults |= FAULT_BLOCK_200A;
-  }
+  while (FAULT_QueuePop(&eventQueue, &event)) {
+    uint8_t line = LineIndex(event.fault);
 
-  // Check BLOCK_100A fault line (PA7)
-  if (HAL_GPIO_ReadPin(FLT_BLOCK_100A_GPIO_Port, FLT_BLOCK_100A_Pin) == GPIO_PIN_RESET) {
-    currentFaults |= FAULT_BLOCK_100A;
-  }
+    switch (event.type) {
+    case FAULT_EVENT_ASSERT:
+      // Every qualified pulse is queued, the fault latches on the first
+      RecordAssert(line, event.time);
+      if (!(faultState & event.fault)) {
+        faultState |= event.fault;
+        EVENT_Post(EVENT_FAULT, event.fault, FAULT_EVENT_ASSERT);
+        TakeSnapshot(event.fault);
+      }
+      break;
+
+    case FAULT_EVENT_RELEASE:
+      RecordRelease(line, event.time);
+      break;
+
+    case FAULT_EVENT_CLEAR:
+      faultState &= ~event.fault;
+      EVENT_Post(EVENT_FAULT, event.fault, FAULT_EVENT_CLEAR);
+      break;
 
-  // Check CHARGE fault line (PA6)
-  if (HAL_GPIO_ReadPin(FLT_CHARGE_GPIO_Port, FLT_CHARGE_Pin) == GPIO_PIN_RESET) {
-    currentFaults |= FAULT_CHARGE;
+    default:
+      break;
+    }
   }
 
-  // Check FAST_CHARGE fault line (PA5)
-  if (HAL_GPIO_ReadPin(FLT_FAST_CHARGE_GPIO_Port, FLT_FAST_CHARGE_Pin) == GPIO_PIN_RESET) {
-    currentFaults |= FAULT_FAST_CHARGE;
+  // Events were dropped: the latched mask is the truth for the line faults
+  if (FAULT_QueueOverflowed(&eventQueue)) {
+    faultState = (faultState & ~FAULT_LINE_MASK) | latchedLines;
   }
 
-  // Update fault state
-  for (int i = 0; i < 4; i++) {
-    uint8_t faultBit = (1 << i);
+  UpdateHistoryHour();
 
-    // If fault is active
-    if (currentFaults & faultBit) {
-      // Set fault state
-      faultState |= faultBit;
-      // Update timestamp
-      faultTimestamps[i] = currentTime;
+  // Bounded flash write rate, faults are rare but a line may chatter
+  uint32_t currentTime = HAL_GetTick();
+  if (historyDirty && currentTime - lastFlushTime >= FAULT_HISTORY_FLUSH_INTERVAL) {
+    if (NVM_Write(NVM_TAG_FAULT_HISTORY, &history, sizeof(history))) {
+      historyDirty = 0;
     }
-    // If fault is not active but was active
-    else if (faultState & faultBit) {
-      // Check if timeout has elapsed
-      if (currentTime - faultTimestamps[i] > FAULT_TIMEOUT) {
-        // Clear fault state
-        faultState &= ~faultBit;
-      }
+    lastFlushTime = currentTime;
+  }
+
+  // Only the latest snapshot is kept across a reset, written at a bounded rate
+  if (snapshotDirty && currentTime - lastSnapshotWrite >= FAULT_SNAPSHOT_PERSIST_INTERVAL) {
+    uint8_t latest = (snapshots.head + FAULT_SNAPSHOT_COUNT - 1) % FAULT_SNAPSHOT_COUNT;
+    if (NVM_Write(NVM_TAG_FAULT_SNAPSHOT, &snapshots.entries[latest], sizeof(FaultSnapshot_t))) {
+      snapshotDirty = 0;
     }
+    lastSnapshotWrite = currentTime;
   }
 }
 
 /**
   * @brief  Set fault flag
+  * @note   Task context, either scheduler level
   * @param  fault: Fault flag to set
   * @retval None
   */
 void FAULT_SetFaultFlag(uint8_t fault)
 {
+  uint32_t key = SCHED_Lock();
   faultState |= fault;
-
-  // Update timestamp for each bit that was set
-  uint32_t currentTime = HAL_GetTick();
-  for (int i = 0; i < 4; i++) {
-    if (fault & (1 << i)) {
-      faultTimestamps[i] = currentTime;
-    }
-  }
+  SCHED_Unlock(key);
 }
 
 /**
   * @brief  Clear fault flag
+  * @note   Task context, either scheduler level
   * @param  fault: Fault flag to clear
   * @retval None
   */
 void FAULT_ClearFaultFlag(uint8_t fault)
 {
+  uint32_t key = SCHED_Lock();
   faultState &= ~fault;
+  SCHED_Unlock(key);
 }
 
 /**
@@ -122,3 +292,560 @@ uint8_t FAULT_GetState(void)
 {
   return faultState;
 }
+
+/**
+  * @brief  De-assert the enables mapped to fault lines that went LOW
+  * @note   Called first thing in the EXTI IRQ handlers
+  * @param  entryCycles: DWT->CYCCNT read on handler entry
+  * @retval None
+  */
+__RAM_FUNC void FAULT_CutoffFromISR(uint32_t entryCycles)
+{
+  uint32_t pending = EXTI->PR;
+  uint16_t cutA = 0;
+  uint16_t cutB = 0;
+
+  isrEntryCycles = entryCycles;
+
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    const FaultLine_t* fl = &faultLines[i];
+    if ((pending & fl->extiLine) && !(fl->port->IDR & fl->extiLine)) {
+      cutA |= fl->cutoffA;
+      cutB |= fl->cutoffB;
+    }
+  }
+
+  // One write per port, upper half of BSRR resets the pins
+  if (cutA) {
+    GPIOA->BSRR = (uint32_t)cutA << 16;
+  }
+  if (cutB) {
+    GPIOB->BSRR = (uint32_t)cutB << 16;
+  }
+
+  uint32_t cycles = DWT->CYCCNT - entryCycles + FAULT_EXCEPTION_ENTRY_CYCLES;
+
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    const FaultLine_t* fl = &faultLines[i];
+    if ((pending & fl->extiLine) && !(fl->port->IDR & fl->extiLine) && (fl->cutoffA | fl->cutoffB)) {
+      lineStats[i].cutoffs++;
+      lineStats[i].lastCycles = cycles;
+      if (cycles > lineStats[i].maxCycles) {
+        lineStats[i].maxCycles = cycles;
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Record an edge on a fault line
+  * @note   Called from HAL_GPIO_EXTI_Callback
+  * @param  pin: FLT_* pin that triggered
+  * @retval None
+  */
+void FAULT_EdgeFromISR(uint16_t pin)
+{
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    const FaultLine_t* fl = &faultLines[i];
+    if (fl->extiLine != pin) {
+      continue;
+    }
+
+    LineState_t* ls = &lineStates[i];
+    ls->low = (fl->port->IDR & pin) ? 0 : 1;
+    ls->edgeCycles = isrEntryCycles;
+    ls->edgeTick = HAL_GetTick();
+
+    if (ls->low && (ls->state == LINE_IDLE || ls->state == LINE_RELEASED || ls->state == LINE_LOCKED)) {
+      // New pulse; a latched fault stays latched while it is qualified
+      ls->prevState = ls->state;
+      ls->state = LINE_PENDING;
+      ls->startCycles = ls->edgeCycles;
+      ls->startTick = ls->edgeTick;
+    } else if (!ls->low && ls->state == LINE_IDLE) {
+      // Both edges of a pulse shorter than the handler latency
+      lineStats[i].glitches++;
+      lineStats[i].lastGlitchUs = 0;
+    }
+
+    UpdateBlockedOutputs();
+    return;
+  }
+}
+
+/**
+  * @brief  Debounce and qualify the fault lines
+  * @note   Called from the SysTick handler every 1 ms
+  * @retval None
+  */
+void FAULT_TickFromISR(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+
+  // EXTI runs at a higher priority, keep the line states consistent
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  uint32_t currentCycles = DWT->CYCCNT;
+  uint8_t clear = clearRequest;
+  clearRequest = 0;
+
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    LineState_t* ls = &lineStates[i];
+
+    // Commanded clear only applies to lines that are no longer active
+    if ((clear & faultLines[i].fault) && (ls->state == LINE_RELEASED || ls->state == LINE_LOCKED)) {
+      ls->retries = 0;
+      lineStats[i].retries = 0;
+      ClearLine(i, currentTime);
+    }
+
+    if (ls->state != LINE_IDLE) {
+      QualifyLine(i, currentCycles, currentTime);
+    }
+  }
+  UpdateBlockedOutputs();
+  uint32_t masked = DWT->CYCCNT - currentCycles;
+  __set_PRIMASK(primask);
+
+  // The whole pass holds off the cutoff, part of its worst case
+  if (masked > eventQueue.stats.maskedCycles) {
+    eventQueue.stats.maskedCycles = masked;
+  }
+}
+
+/**
+  * @brief  Get enable pins held off by active faults
+  * @param  port: GPIOA or GPIOB
+  * @retval Pin mask that must not be driven high
+  */
+uint16_t FAULT_GetBlockedOutputs(GPIO_TypeDef* port)
+{
+  uint16_t blocked = 0;
+
+  // Held off until the main loop has seen the clear as well
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    if (faultState & faultLines[i].fault) {
+      blocked |= (port == GPIOA) ? faultLines[i].cutoffA : faultLines[i].cutoffB;
+    }
+  }
+
+  if (port == GPIOA) {
+    return blocked | blockedA;
+  }
+  if (port == GPIOB) {
+    return blocked | blockedB;
+  }
+  return 0;
+}
+
+/**
+  * @brief  Get per-line pulse and cutoff statistics
+  * @retval Array of FAULT_LINE_COUNT entries indexed by fault bit
+  */
+const FaultLineStats_t* FAULT_GetLineStats(void)
+{
+  return lineStats;
+}
+
+/**
+  * @brief  Get fault event queue statistics
+  * @retval Pointer to the statistics
+  */
+const FaultQueueStats_t* FAULT_GetQueueStats(void)
+{
+  return &eventQueue.stats;
+}
+
+/**
+  * @brief  Clear latched faults whose lines are no longer active
+  * @note   Task context, applied on the next SysTick
+  * @param  faults: Fault flags to clear
+  * @retval None
+  */
+void FAULT_ClearLatched(uint8_t faults)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  clearRequest |= faults;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Get lines latched until a commanded clear
+  * @retval Fault flags waiting for FAULT_ClearLatched
+  */
+uint8_t FAULT_GetLockedLines(void)
+{
+  return lockedLines;
+}
+
+/**
+  * @brief  Get the lifetime fault history of every line
+  * @retval Pointer to the history
+  */
+const FaultHistory_t* FAULT_GetHistory(void)
+{
+  return &history;
+}
+
+/**
+  * @brief  Get the snapshots taken on the latest latched faults
+  * @retval Pointer to the snapshots
+  */
+const FaultSnapshots_t* FAULT_GetSnapshots(void)
+{
+  return &snapshots;
+}
+
+/**
+  * @brief  Advance the state of one line once its level is stable
+  * @param  line: Index into faultLines
+  * @param  currentCycles: Current DWT time
+  * @param  currentTime: Current HAL tick
+  * @retval None
+  */
+static void QualifyLine(uint8_t line, uint32_t currentCycles, uint32_t currentTime)
+{
+  LineState_t* ls = &lineStates[line];
+  FaultLineStats_t* stats = &lineStats[line];
+  uint8_t faultBit = faultLines[line].fault;
+
+  // Cycle counter wraps after ~59 s, an edge two ticks back is stable anyway
+  uint8_t stable = (currentTime - ls->edgeTick >= 2) ||
+                   (currentCycles - ls->edgeCycles >= FAULT_DEBOUNCE_US * cyclesPerUs);
+  if (!stable) {
+    return;
+  }
+
+  switch (ls->state) {
+  case LINE_PENDING:
+    if (!ls->low) {
+      // Released before qualification: glitch, return to the previous state;
+      // a locked line stays locked instead of running the policy again
+      stats->glitches++;
+      stats->lastGlitchUs = PulseWidthUs(ls, ls->edgeCycles, ls->edgeTick);
+      ls->state = ls->prevState;
+    } else if (PulseWidthUs(ls, currentCycles, currentTime) >= FAULT_MIN_PULSE_US) {
+      ls->state = LINE_ASSERTED;
+      stats->faults++;
+      // A quiet period since the last clear restarts the backoff
+      if (!ls->latched && currentTime - ls->clearTick >= FAULT_RETRY_RESET_TIME) {
+        ls->retries = 0;
+        stats->retries = 0;
+      }
+      if (!ls->latched) {
+        ls->latched = 1;
+        latchedLines |= faultBit;
+      }
+      PushEvent(faultBit, FAULT_EVENT_ASSERT, TIMEBASE_FromCycles(ls->startCycles), 0);
+    }
+    break;
+
+  case LINE_ASSERTED:
+    if (!ls->low) {
+      ls->state = LINE_RELEASED;
+      ls->releaseTick = ls->edgeTick;
+      stats->lastPulseUs = PulseWidthUs(ls, ls->edgeCycles, ls->edgeTick);
+      if (stats->lastPulseUs > stats->maxPulseUs) {
+        stats->maxPulseUs = stats->lastPulseUs;
+      }
+      PushEvent(faultBit, FAULT_EVENT_RELEASE, TIMEBASE_FromCycles(ls->edgeCycles), stats->lastPulseUs);
+    }
+    break;
+
+  case LINE_RELEASED:
+    ReleaseLine(line, currentTime);
+    break;
+
+  case LINE_LOCKED:
+    break;
+
+  default:
+    ls->state = LINE_IDLE;
+    break;
+  }
+}
+
+/**
+  * @brief  Apply the recovery policy to a line that is HIGH again
+  * @param  line: Index into faultLines
+  * @param  currentTime: Current HAL tick
+  * @retval None
+  */
+static void ReleaseLine(uint8_t line, uint32_t currentTime)
+{
+  LineState_t* ls = &lineStates[line];
+  const FaultPolicy_t* policy = &faultPolicies[line];
+  uint32_t holdTime = policy->holdTime;
+
+  // Hold time doubles with every retry
+  for (uint8_t i = 0; i < ls->retries && holdTime < policy->maxHoldTime; i++) {
+    holdTime <<= 1;
+  }
+  if (holdTime > policy->maxHoldTime) {
+    holdTime = policy->maxHoldTime;
+  }
+
+  if (currentTime - ls->releaseTick < holdTime) {
+    return;
+  }
+
+  if (policy->policy == FAULT_POLICY_RETRY && ls->retries < policy->retryLimit) {
+    ls->retries++;
+    lineStats[line].retries = ls->retries;
+    ClearLine(line, currentTime);
+    return;
+  }
+
+  if (policy->policy == FAULT_POLICY_RETRY) {
+    lineStats[line].lockouts++;
+  }
+  ls->state = LINE_LOCKED;
+  lockedLines |= faultLines[line].fault;
+}
+
+/**
+  * @brief  Clear the fault of a line and report it to the main loop
+  * @param  line: Index into faultLines
+  * @param  currentTime: Current HAL tick
+  * @retval None
+  */
+static void ClearLine(uint8_t line, uint32_t currentTime)
+{
+  LineState_t* ls = &lineStates[line];
+  uint8_t faultBit = faultLines[line].fault;
+
+  ls->state = LINE_IDLE;
+  ls->latched = 0;
+  ls->clearTick = currentTime;
+  latchedLines &= ~faultBit;
+  lockedLines &= ~faultBit;
+  PushEvent(faultBit, FAULT_EVENT_CLEAR, TIMEBASE_Now(), 0);
+}
+
+/**
+  * @brief  Queue a fault event for the main loop
+  * @note   Producer side, SysTick context only
+  * @param  fault: FaultStateEnum bit
+  * @param  type: FaultEventEnum
+  * @param  time: Timebase time of the event
+  * @param  widthUs: Pulse width, 0 if not applicable
+  * @retval None
+  */
+static void PushEvent(uint8_t fault, uint8_t type, Timestamp_t time, uint32_t widthUs)
+{
+  FaultEvent_t event;
+
+  event.time = time;
+  event.widthUs = widthUs;
+  event.fault = fault;
+  event.type = type;
+
+  // A dropped event is counted, FAULT_Check resyncs from latchedLines
+  FAULT_QueuePush(&eventQueue, &event);
+}
+
+/**
+  * @brief  Width of the pulse started at the line's start time
+  * @param  ls: Line state
+  * @param  endCycles: DWT time of the pulse end
+  * @param  endTick: HAL tick of the pulse end
+  * @retval Width in us, from the cycle counter below 30 s, from the tick above
+  */
+static uint32_t PulseWidthUs(const LineState_t* ls, uint32_t endCycles, uint32_t endTick)
+{
+  uint32_t ms = endTick - ls->startTick;
+
+  if (ms < 30000) {
+    return (endCycles - ls->startCycles) / cyclesPerUs;
+  }
+  return (ms < UINT32_MAX / 1000) ? ms * 1000 : UINT32_MAX;
+}
+
+/**
+  * @brief  Recompute the blocked enables from the line states
+  * @retval None
+  */
+static void UpdateBlockedOutputs(void)
+{
+  uint16_t maskA = 0;
+  uint16_t maskB = 0;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    if (lineStates[i].state != LINE_IDLE) {
+      maskA |= faultLines[i].cutoffA;
+      maskB |= faultLines[i].cutoffB;
+    }
+  }
+  blockedA = maskA;
+  blockedB = maskB;
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Count a qualified pulse and its inter-arrival time
+  * @param  line: Index into faultLines
+  * @param  time: Start of the pulse
+  * @retval None
+  */
+static void RecordAssert(uint8_t line, Timestamp_t time)
+{
+  if (line >= FAULT_LINE_COUNT) {
+    return;
+  }
+
+  FaultLineHistory_t* h = &history.lines[line];
+  uint32_t seconds = LIFETIME_GetOperatingSeconds();
+  uint8_t lineBit = (uint8_t)(1 << line);
+
+  if (h->events > 0) {
+    uint32_t interval;
+
+    // Exact within this boot, operating time resolution across resets
+    if (assertSeen & lineBit) {
+      uint64_t ms = TIMEBASE_ToMicros(time - assertTimes[line]) / 1000;
+      interval = ms < UINT32_MAX ? (uint32_t)ms : UINT32_MAX;
+    } else {
+      uint32_t elapsed = seconds - h->lastSeconds;
+      interval = elapsed < UINT32_MAX / 1000 ? elapsed * 1000 : UINT32_MAX;
+    }
+
+    h->intervals[h->intervalHead] = interval;
+    h->intervalHead = (h->intervalHead + 1) % FAULT_HISTORY_INTERVALS;
+    if (h->intervalCount < FAULT_HISTORY_INTERVALS) {
+      h->intervalCount++;
+    }
+  }
+
+  h->events++;
+  h->lastSeconds = seconds;
+  if (h->hourEvents < UINT16_MAX) {
+    h->hourEvents++;
+  }
+  if (h->hourEvents > h->maxHourEvents) {
+    h->maxHourEvents = h->hourEvents;
+  }
+
+  assertTimes[line] = time;
+  assertSeen |= lineBit;
+  historyDirty = 1;
+}
+
+/**
+  * @brief  Add the length of a finished pulse to the active time
+  * @param  line: Index into faultLines
+  * @param  time: End of the pulse
+  * @retval None
+  */
+static void RecordRelease(uint8_t line, Timestamp_t time)
+{
+  if (line >= FAULT_LINE_COUNT || !(assertSeen & (1 << line))) {
+    return;
+  }
+
+  FaultLineHistory_t* h = &history.lines[line];
+  uint64_t ms = TIMEBASE_ToMicros(time - assertTimes[line]) / 1000;
+  uint32_t width = ms < UINT32_MAX ? (uint32_t)ms : UINT32_MAX;
+
+  h->activeMs = (h->activeMs + width >= h->activeMs) ? h->activeMs + width : UINT32_MAX;
+  if (width > h->longestMs) {
+    h->longestMs = width;
+  }
+  historyDirty = 1;
+}
+
+/**
+  * @brief  Roll the events per hour counters over each operating hour
+  * @retval None
+  */
+static void UpdateHistoryHour(void)
+{
+  uint32_t elapsed = LIFETIME_GetOperatingSeconds() - history.hourStart;
+
+  if (elapsed < 3600) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    FaultLineHistory_t* h = &history.lines[i];
+    // More than one hour passed: the later hours had no pulses
+    h->lastHourEvents = (elapsed < 7200) ? h->hourEvents : 0;
+    h->hourEvents = 0;
+  }
+  history.hourStart += elapsed - elapsed % 3600;
+  historyDirty = 1;
+}
+
+/**
+  * @brief  Snapshot the acquisition ring and the outputs for a latched fault
+  * @note   Called right after the EVENT_FAULT post, whose timestamp it takes
+  * @param  fault: FaultStateEnum bit that latched
+  * @retval None
+  */
+static void TakeSnapshot(uint8_t fault)
+{
+  FaultSnapshot_t* snapshot = &snapshots.entries[snapshots.head];
+  Event_t event;
+
+  if (EVENT_Get(EVENT_GetCount() - 1, &event)) {
+    snapshot->timestamp = event.timestamp;
+  } else {
+    snapshot->timestamp = HAL_GetTick();
+  }
+  snapshot->operatingSeconds = LIFETIME_GetOperatingSeconds();
+  snapshot->fault = fault;
+  snapshot->faults = faultState;
+  snapshot->chargeMode = SYSTEM_GetChargeMode();
+  snapshot->chargeInhibit = SYSTEM_GetChargeInhibit();
+  snapshot->output = SYSTEM_IsPowerOutputOn();
+  snapshot->relay = LATCH_GetStats()->position;
+  snapshot->restored = 0;
+
+  // Only the frames kept are copied, straight out of the ring
+  snapshot->samples = ADC_CopyRecent(snapshot->mv, FAULT_SNAPSHOT_SAMPLES);
+
+  snapshots.head = (snapshots.head + 1) % FAULT_SNAPSHOT_COUNT;
+  if (snapshots.count < FAULT_SNAPSHOT_COUNT) {
+    snapshots.count++;
+  }
+  snapshotDirty = 1;
+}
+
+/**
+  * @brief  Find the line of a fault bit
+  * @param  fault: FaultStateEnum bit
+  * @retval Index into faultLines, FAULT_LINE_COUNT if none
+  */
+static uint8_t LineIndex(uint8_t fault)
+{
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    if (faultLines[i].fault == fault) {
+      return i;
+    }
+  }
+  return FAULT_LINE_COUNT;
+}
+
+/**
+  * @brief  Serve the interrupts from a copy of the vector table in RAM
+  * @note   A flash page erase stalls every fetch from flash, the vector
+  *         read included; with the table, the EXTI handlers and the
+  *         cutoff in RAM the outputs still drop during an erase
+  * @retval None
+  */
+static void RelocateVectors(void)
+{
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+
+  for (uint16_t i = 0; i < sizeof(ramVectors) / sizeof(ramVectors[0]); i++) {
+    ramVectors[i] = g_pfnVectors[i];
+  }
+  SCB->VTOR = (uint32_t)ramVectors;
+  __DSB();
+
+  __set_PRIMASK(primask);
+}
@@ -0,0 +1,444 @@
+/**
+  ******************************************************************************
+  * @file    latch_relay.c
+  * @brief   Latching relay actuation and feedback module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+
+/* Includes ------------------------------------------------------------------*/
+#include "latch_relay.h"
+#include "fault_handling.h"
+#include "event_log.h"
+#include "timebase.h"
+#include "scheduler.h"
+
+/* Private types -------------------------------------------------------------*/
+typedef enum {
+  ENGINE_IDLE = 0,  // Both coils off, the next request may start
+  ENGINE_PULSE,     // One coil driven
+  ENGINE_OFF        // Both coils off for LATCH_MIN_OFF_TIME
+} EngineStateEnum;
+
+typedef struct {
+  uint32_t changeCount;  // Debounced position changes when the pulse ended
+  uint32_t cycles;       // Coil on to confirmed feedback change, 0 if not seen
+  uint8_t target;        // LatchPositionEnum commanded
+  uint8_t result;        // LatchResultEnum
+  uint8_t retries;       // Repeated pulses
+  uint8_t position;      // Feedback position when the pulse ended
+} PulseResult_t;
+
+/* Private variables ---------------------------------------------------------*/
+static LatchStats_t stats;
+static volatile uint8_t position = LATCH_POSITION_UNKNOWN; // Debounced, written by SysTick
+static volatile uint32_t changeCycles = 0;  // DWT->CYCCNT when the new position was first seen
+static volatile uint32_t changeCount = 0;   // Debounced position changes
+static uint8_t candidate = LATCH_POSITION_UNKNOWN;
+static uint8_t candidateTicks = 0;
+static uint32_t candidateCycles = 0;
+static uint32_t seenChanges = 0;
+
+/* Requests: tasks produce, SysTick consumes; results the other way round */
+static uint8_t requestQueue[LATCH_QUEUE_SIZE];
+static volatile uint8_t requestHead = 0;
+static volatile uint8_t requestTail = 0;
+static PulseResult_t resultQueue[LATCH_QUEUE_SIZE];
+static volatile uint8_t resultHead = 0;
+static volatile uint8_t resultTail = 0;
+
+/* Pulse engine, SysTick context only except the state read by LATCH_IsBusy */
+static volatile uint8_t engine = ENGINE_IDLE;
+static volatile uint8_t cancelRequest = 0;
+static uint8_t pulseTarget = LATCH_POSITION_UNKNOWN;
+static uint8_t pulseAttempt = 0;
+static uint8_t pulseConfirmedBefore = 0;
+static uint8_t retryPending = 0;
+static uint32_t pulseStartTick = 0;
+static uint32_t pulseStartCount = 0;
+static uint32_t pulseStartCycles = 0;
+static uint32_t offStartTick = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static void RunEngine(void);
+static void StartPulse(void);
+static void FinishPulse(uint8_t result);
+static void TakeResult(const PulseResult_t* result);
+static uint8_t ReadFeedback(void);
+static uint8_t IsCoilDriven(uint8_t coil);
+static void DriveCoil(uint8_t coil);
+
+/**
+  * @brief  Take the current feedback position as the expected position
+  * @retval None
+  */
+void LATCH_Init(void)
+{
+  uint8_t* raw = (uint8_t*)&stats;
+  for (uint16_t i = 0; i < sizeof(stats); i++) {
+    raw[i] = 0;
+  }
+
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  candidate = ReadFeedback();
+  candidateTicks = LATCH_DEBOUNCE_TICKS;
+  position = candidate;
+  seenChanges = changeCount;
+  requestHead = 0;
+  requestTail = 0;
+  resultHead = 0;
+  resultTail = 0;
+  engine = ENGINE_IDLE;
+  cancelRequest = 0;
+  retryPending = 0;
+  __set_PRIMASK(primask);
+
+  stats.position = position;
+  stats.expected = position;
+}
+
+/**
+  * @brief  Take over finished pulses and report position changes that were not commanded
+  * @note   Preempting scheduler level only
+  * @retval None
+  */
+void LATCH_Update(void)
+{
+  // Sampled before the results so a pulse ending in between is not judged
+  uint8_t busy = LATCH_IsBusy();
+  uint8_t tail = resultTail;
+
+  while (tail != resultHead) {
+    PulseResult_t result = resultQueue[tail];
+
+    // Release the slot only after it is read
+    __DMB();
+    tail = (tail + 1) & (LATCH_QUEUE_SIZE - 1);
+    resultTail = tail;
+
+    TakeResult(&result);
+  }
+
+  uint8_t current = position;
+
+  stats.position = current;
+  if (busy || changeCount == seenChanges) {
+    return;
+  }
+  seenChanges = changeCount;
+
+  if (current != stats.expected) {
+    stats.spontaneous++;
+    stats.expected = current;
+    stats.lastResult = LATCH_RESULT_SPONTANEOUS;
+    FAULT_SetFaultFlag(FAULT_RELAY);
+    EVENT_Post(EVENT_RELAY, LATCH_RESULT_SPONTANEOUS, current);
+  }
+}
+
+/**
+  * @brief  Queue a coil pulse that lasts until the feedback confirms the position
+  * @note   Task context, either scheduler level; returns at once
+  * @param  target: LATCH_POSITION_SET or LATCH_POSITION_RESET
+  * @retval 1 if queued, 0 if the target is invalid or the queue is full
+  */
+uint8_t LATCH_Request(uint8_t target)
+{
+  uint8_t queued = 0;
+
+  if (target != LATCH_POSITION_SET && target != LATCH_POSITION_RESET) {
+    return 0;
+  }
+
+  // Requested from both scheduler levels; the lock is held for the enqueue only
+  uint32_t key = SCHED_Lock();
+  uint8_t head = requestHead;
+  uint8_t next = (head + 1) & (LATCH_QUEUE_SIZE - 1);
+
+  if (next == requestTail) {
+    stats.dropped++;
+  } else {
+    requestQueue[head] = target;
+
+    // Publish the slot only after it is written
+    __DMB();
+    requestHead = next;
+    stats.actuations++;
+    queued = 1;
+  }
+  SCHED_Unlock(key);
+
+  return queued;
+}
+
+/**
+  * @brief  End the running pulse and drop the queued ones
+  * @note   Task context; both coils are off on return
+  * @retval None
+  */
+void LATCH_Cancel(void)
+{
+  // Flag first: from here on the engine starts no pulse, it reports the
+  // running one as aborted and empties the queue on its next tick
+  cancelRequest = 1;
+  DriveCoil(LATCH_POSITION_UNKNOWN);
+}
+
+/**
+  * @brief  Check whether a pulse is running, pending or in its off time
+  * @retval 1 if busy
+  */
+uint8_t LATCH_IsBusy(void)
+{
+  return engine != ENGINE_IDLE || requestHead != requestTail;
+}
+
+/**
+  * @brief  Sample and debounce the feedback contacts and run the pulse engine
+  * @note   Called from the SysTick handler every 1 ms
+  * @retval None
+  */
+void LATCH_TickFromISR(void)
+{
+  uint8_t sample = ReadFeedback();
+
+  if (sample != candidate) {
+    candidate = sample;
+    candidateCycles = DWT->CYCCNT;
+    candidateTicks = 0;
+  } else if (candidateTicks < LATCH_DEBOUNCE_TICKS) {
+    candidateTicks++;
+    if (candidateTicks == LATCH_DEBOUNCE_TICKS && candidate != position) {
+      changeCycles = candidateCycles;
+      position = candidate;
+      changeCount++;
+    }
+  }
+
+  // On the fresh feedback, so a confirmed pulse ends within this tick
+  RunEngine();
+}
+
+/**
+  * @brief  Get actuation statistics and the feedback position
+  * @retval Pointer to the statistics
+  */
+const LatchStats_t* LATCH_GetStats(void)
+{
+  return &stats;
+}
+
+/**
+  * @brief  Advance the pulse engine by one tick
+  * @note   SysTick context only
+  * @retval None
+  */
+static void RunEngine(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+
+  if (engine == ENGINE_PULSE) {
+    // Already in position: feedback can not confirm, give the full pulse
+    uint8_t confirmed = !pulseConfirmedBefore && changeCount != pulseStartCount &&
+                        position == pulseTarget;
+    uint8_t cut = cancelRequest || !IsCoilDriven(pulseTarget);
+
+    if (!confirmed && !cut && currentTime - pulseStartTick < LATCH_PULSE_TIME) {
+      return;
+    }
+
+    DriveCoil(LATCH_POSITION_UNKNOWN);
+    engine = ENGINE_OFF;
+    offStartTick = currentTime;
+
+    if (cut) {
+      FinishPulse(LATCH_RESULT_ABORTED);
+    } else if (position == pulseTarget) {
+      FinishPulse(pulseAttempt == 0 ? LATCH_RESULT_OK : LATCH_RESULT_RETRIED);
+    } else if (pulseAttempt < LATCH_RETRY_LIMIT) {
+      // Retried after the off time like any other pulse
+      pulseAttempt++;
+      pulseConfirmedBefore = 0;
+      retryPending = 1;
+    } else {
+      FinishPulse(LATCH_RESULT_FAILED);
+    }
+    return;
+  }
+
+  if (cancelRequest) {
+    if (retryPending) {
+      retryPending = 0;
+      FinishPulse(LATCH_RESULT_ABORTED);
+    }
+    requestTail = requestHead;
+    cancelRequest = 0;
+  }
+
+  if (engine == ENGINE_OFF) {
+    if (currentTime - offStartTick < LATCH_MIN_OFF_TIME) {
+      return;
+    }
+    engine = ENGINE_IDLE;
+  }
+
+  // Wait for room to report the outcome before starting a pulse
+  if (((resultHead + 1) & (LATCH_QUEUE_SIZE - 1)) == resultTail) {
+    return;
+  }
+
+  if (retryPending) {
+    retryPending = 0;
+    StartPulse();
+    return;
+  }
+
+  uint8_t tail = requestTail;
+  if (tail != requestHead) {
+    pulseTarget = requestQueue[tail];
+
+    // Release the slot only after it is read
+    __DMB();
+    requestTail = (tail + 1) & (LATCH_QUEUE_SIZE - 1);
+
+    pulseAttempt = 0;
+    pulseConfirmedBefore = (position == pulseTarget);
+    StartPulse();
+  }
+}
+
+/**
+  * @brief  Energize the coil of the pulse target
+  * @note   SysTick context only
+  * @retval None
+  */
+static void StartPulse(void)
+{
+  pulseStartTick = HAL_GetTick();
+  pulseStartCount = changeCount;
+  pulseStartCycles = DWT->CYCCNT;
+  engine = ENGINE_PULSE;
+  DriveCoil(pulseTarget);
+}
+
+/**
+  * @brief  Queue the outcome of the pulse for LATCH_Update
+  * @note   SysTick context only, a free slot is checked before every pulse
+  * @param  result: LatchResultEnum
+  * @retval None
+  */
+static void FinishPulse(uint8_t result)
+{
+  uint8_t head = resultHead;
+  PulseResult_t* entry = &resultQueue[head];
+
+  entry->changeCount = changeCount;
+  entry->cycles = 0;
+  if (!pulseConfirmedBefore && changeCount != pulseStartCount && position == pulseTarget &&
+      (int32_t)(changeCycles - pulseStartCycles) > 0) {
+    entry->cycles = changeCycles - pulseStartCycles;
+  }
+  entry->target = pulseTarget;
+  entry->result = result;
+  entry->retries = pulseAttempt;
+  entry->position = position;
+
+  // Publish the slot only after it is written
+  __DMB();
+  resultHead = (head + 1) & (LATCH_QUEUE_SIZE - 1);
+}
+
+/**
+  * @brief  Account a finished pulse and raise or clear FAULT_RELAY
+  * @param  result: Outcome reported by the engine
+  * @retval None
+  */
+static void TakeResult(const PulseResult_t* result)
+{
+  // Changes seen during the pulse were commanded
+  seenChanges = result->changeCount;
+  stats.retries += result->retries;
+  stats.lastResult = result->result;
+
+  if (result->result == LATCH_RESULT_ABORTED) {
+    // Nothing known about the relay, take what the feedback shows
+    stats.aborted++;
+    stats.expected = result->position;
+  } else if (result->result == LATCH_RESULT_FAILED) {
+    stats.failures++;
+    stats.expected = result->target;
+    FAULT_SetFaultFlag(FAULT_RELAY);
+  } else {
+    uint32_t actuationUs = (uint32_t)TIMEBASE_ToMicros((Timestamp_t)result->cycles);
+    if (actuationUs > 0) {
+      stats.lastActuationUs = actuationUs;
+      if (actuationUs > stats.maxActuationUs) {
+        stats.maxActuationUs = actuationUs;
+      }
+    }
+    stats.expected = result->target;
+    FAULT_ClearFaultFlag(FAULT_RELAY);
+  }
+
+  if (result->result != LATCH_RESULT_OK) {
+    EVENT_Post(EVENT_RELAY, result->result, result->target);
+  }
+}
+
+/**
+  * @brief  Decode the feedback contacts
+  * @retval LatchPositionEnum
+  */
+static uint8_t ReadFeedback(void)
+{
+  uint8_t set = HAL_GPIO_ReadPin(LATCH_FB1_GPIO_Port, LATCH_FB1_Pin) == LATCH_FB_ACTIVE;
+  uint8_t reset = HAL_GPIO_ReadPin(LATCH_FB2_GPIO_Port, LATCH_FB2_Pin) == LATCH_FB_ACTIVE;
+
+  if (set && reset) {
+    return LATCH_POSITION_INVALID;
+  }
+  if (set) {
+    return LATCH_POSITION_SET;
+  }
+  if (reset) {
+    return LATCH_POSITION_RESET;
+  }
+  return LATCH_POSITION_UNKNOWN;
+}
+
+/**
+  * @brief  Check the output latch of a coil
+  * @param  coil: LATCH_POSITION_SET (IN1) or LATCH_POSITION_RESET (IN2)
+  * @retval 1 if the coil output is on
+  */
+static uint8_t IsCoilDriven(uint8_t coil)
+{
+  if (coil == LATCH_POSITION_SET) {
+    return (LATCH_IN1_GPIO_Port->ODR & LATCH_IN1_Pin) != 0;
+  }
+  return (LATCH_IN2_GPIO_Port->ODR & LATCH_IN2_Pin) != 0;
+}
+
+/**
+  * @brief  Energize one coil, never both
+  * @param  coil: LATCH_POSITION_SET (IN1), LATCH_POSITION_RESET (IN2), other values release both
+  * @retval None
+  */
+static void DriveCoil(uint8_t coil)
+{
+  HAL_GPIO_WritePin(LATCH_IN1_GPIO_Port, LATCH_IN1_Pin, GPIO_PIN_RESET);
+  HAL_GPIO_WritePin(LATCH_IN2_GPIO_Port, LATCH_IN2_Pin, GPIO_PIN_RESET);
+
+  if (coil == LATCH_POSITION_SET) {
+    HAL_GPIO_WritePin(LATCH_IN1_GPIO_Port, LATCH_IN1_Pin, GPIO_PIN_SET);
+  } else if (coil == LATCH_POSITION_RESET) {
+    HAL_GPIO_WritePin(LATCH_IN2_GPIO_Port, LATCH_IN2_Pin, GPIO_PIN_SET);
+  }
+}
@@ -0,0 +1,188 @@
+/**
+  ******************************************************************************
+  * @file    lifetime_stats.c
+  * @brief   Lifetime statistics (odometer) module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "lifetime_stats.h"
+#include "system_control.h"
+#include "nvm_storage.h"
+
+/* Private variables ---------------------------------------------------------*/
+static LifetimeStats_t stats;
+static float socReference[BATTERY_BANK_COUNT];   // SoC at the last counted step
+static uint8_t lastAlarm[BATTERY_BANK_COUNT];    // Alarm level at the last update
+static uint32_t lastUpdateTime = 0;
+static uint32_t lastFlushTime = 0;
+static uint32_t stateMilliseconds = 0;           // Time not yet added to stateSeconds
+static uint8_t statsDirty = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static float EstimateSoc(float voltage);
+static void UpdateBank(uint8_t bank);
+
+/**
+  * @brief  Initialize the lifetime statistics and restore them from flash
+  * @note   NVM_Init must have been called
+  * @retval None
+  */
+void LIFETIME_Init(void)
+{
+  if (!NVM_Read(NVM_TAG_LIFETIME, &stats, sizeof(stats))) {
+    // No valid record: start from zero
+    uint8_t* raw = (uint8_t*)&stats;
+    for (uint16_t i = 0; i < sizeof(stats); i++) {
+      raw[i] = 0;
+    }
+  }
+
+  for (int i = 0; i < BATTERY_BANK_COUNT; i++) {
+    socReference[i] = -1.0f; // Taken from the first sample
+    lastAlarm[i] = BATTERY_ALARM_NONE;
+  }
+
+  lastUpdateTime = HAL_GetTick();
+  lastFlushTime = lastUpdateTime;
+  stateMilliseconds = 0;
+  statsDirty = 0;
+}
+
+/**
+  * @brief  Accumulate statistics and flush them to flash when due
+  * @retval None
+  */
+void LIFETIME_Update(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+  uint32_t elapsed = currentTime - lastUpdateTime;
+
+  if (elapsed < LIFETIME_UPDATE_INTERVAL) {
+    return;
+  }
+  lastUpdateTime = currentTime;
+
+  // Time in the current system state
+  stateMilliseconds += elapsed;
+  if (systemState.state < STATE_COUNT) {
+    stats.stateSeconds[systemState.state] += stateMilliseconds / 1000;
+    statsDirty = 1;
+  }
+  stateMilliseconds %= 1000;
+
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    UpdateBank(bank);
+  }
+
+  // Bounded flash write rate for wear leveling
+  if (statsDirty && currentTime - lastFlushTime >= LIFETIME_FLUSH_INTERVAL) {
+    if (NVM_Write(NVM_TAG_LIFETIME, &stats, sizeof(stats))) {
+      statsDirty = 0;
+    }
+    lastFlushTime = currentTime;
+  }
+}
+
+/**
+  * @brief  Get the lifetime statistics
+  * @retval Pointer to the statistics
+  */
+const LifetimeStats_t* LIFETIME_GetStats(void)
+{
+  return &stats;
+}
+
+/**
+  * @brief  Get total operating time over the unit's lifetime
+  * @retval Seconds spent in all system states
+  */
+uint32_t LIFETIME_GetOperatingSeconds(void)
+{
+  uint32_t seconds = 0;
+
+  for (int i = 0; i < STATE_COUNT; i++) {
+    seconds += stats.stateSeconds[i];
+  }
+  return seconds;
+}
+
+/**
+  * @brief  Get equivalent full cycles of a bank
+  * @param  bank: BANK_A or BANK_B
+  * @retval Equivalent full cycles (discharged Ah / nominal capacity)
+  */
+float LIFETIME_GetEquivalentCycles(uint8_t bank)
+{
+  if (bank >= BATTERY_BANK_COUNT) {
+    return 0.0f;
+  }
+  return stats.banks[bank].dischargeAh / LIFETIME_CAPACITY_AH;
+}
+
+/**
+  * @brief  Estimate state of charge from bank voltage
+  * @param  voltage: Bank voltage
+  * @retval State of charge (0.0 - 1.0)
+  */
+static float EstimateSoc(float voltage)
+{
+  float soc = (voltage - BATTERY_MIN_VOLTAGE) / (BATTERY_MAX_VOLTAGE - BATTERY_MIN_VOLTAGE);
+
+  if (soc < 0.0f) soc = 0.0f;
+  if (soc > 1.0f) soc = 1.0f;
+
+  return soc;
+}
+
+/**
+  * @brief  Accumulate throughput and deep discharges of one bank
+  * @note   Without a current sensor, throughput is the SoC change times the
+  *         nominal capacity, counted as discharge while the output is on and
+  *         as charge while a charge mode is active.
+  * @param  bank: Bank index
+  * @retval None
+  */
+static void UpdateBank(uint8_t bank)
+{
+  LifetimeBank_t* bankStats = &stats.banks[bank];
+  float voltage = systemState.voltages[bank];
+  float soc = EstimateSoc(voltage);
+  uint8_t alarm = BATTERY_GetAlarm(bank);
+
+  // Deep discharge: entry into the critical level or below
+  if (alarm >= BATTERY_ALARM_CRITICAL && lastAlarm[bank] < BATTERY_ALARM_CRITICAL) {
+    bankStats->deepDischarges++;
+    statsDirty = 1;
+  }
+  lastAlarm[bank] = alarm;
+
+  if (socReference[bank] < 0.0f) {
+    socReference[bank] = soc;
+    return;
+  }
+
+  float delta = soc - socReference[bank];
+  if (delta > -LIFETIME_SOC_STEP && delta < LIFETIME_SOC_STEP) {
+    return;
+  }
+  socReference[bank] = soc;
+
+  float ah = (delta < 0.0f ? -delta : delta) * LIFETIME_CAPACITY_AH;
+
+  if (delta < 0.0f && SYSTEM_IsPowerOutputOn()) {
+    bankStats->dischargeAh += ah;
+    bankStats->dischargeWh += ah * voltage;
+    statsDirty = 1;
+  } else if (delta > 0.0f && SYSTEM_GetChargeMode() != CHARGE_OFF) {
+    bankStats->chargeAh += ah;
+    bankStats->chargeWh += ah * voltage;
+    statsDirty = 1;
+  }
+}
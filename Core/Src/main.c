@@ -28,7 +28,24 @@
 #include "system_control.h"
 #include "battery_management.h"
 #include "fault_handling.h"
-//#include "usb_com.h"
+#include "event_log.h"
+#include "nvm_storage.h"
+#include "lifetime_stats.h"
+#include "state_machine.h"
+#include "standby_monitor.h"
+#include "charge_control.h"
+#include "equalize.h"
+#include "timebase.h"
+#include "watchdog.h"
+#include "crash_report.h"
+#include "supply_monitor.h"
+#include "latch_relay.h"
+#include "output_check.h"
+#include "protection.h"
+#include "scheduler.h"
+#include "power_manager.h"
+#include "usb_com.h"
+#include <string.h>
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -38,7 +55,33 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+/* Scheduler task periods, phases (ms) and budgets (us)
+ * Priority, highest first: the level, then the registration order in main()
+ *   1 TaskFaults        preempting   fault events, relay pulse
+ *   2 TaskFrame         preempting   sample frame, disconnect, protection rules
+ *   3 TaskControl       background   charge, equalization, outputs
+ *   4 TaskJournal       background   event journal
+ *   5 TaskComms         background   USB commands and reports
+ *   6 TaskHousekeeping  background   lifetime and standby statistics
+ * Stack bound of each task: maxStack, the last field of its 'J' entry */
+#define TASK_FAULTS_PERIOD        1
+#define TASK_FAULTS_PHASE         0
+#define TASK_FAULTS_BUDGET        200
+#define TASK_FRAME_PERIOD         5
+#define TASK_FRAME_PHASE          0
+#define TASK_FRAME_BUDGET         1000
+#define TASK_CONTROL_PERIOD       10
+#define TASK_CONTROL_PHASE        2
+#define TASK_CONTROL_BUDGET       500
+#define TASK_JOURNAL_PERIOD       2
+#define TASK_JOURNAL_PHASE        1
+#define TASK_JOURNAL_BUDGET       500
+#define TASK_COMMS_PERIOD         10
+#define TASK_COMMS_PHASE          7
+#define TASK_COMMS_BUDGET         2000
+#define TASK_HOUSEKEEPING_PERIOD  100
+#define TASK_HOUSEKEEPING_PHASE   53
+#define TASK_HOUSEKEEPING_BUDGET  500
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -55,6 +98,13 @@
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 /* USER CODE BEGIN PFP */
+void ProcessCommand(void);
+static void TaskFaults(void);
+static void TaskFrame(void);
+static void TaskControl(void);
+static void TaskJournal(void);
+static void TaskComms(void);
+static void TaskHousekeeping(void);
 
 /* USER CODE END PFP */
 
@@ -99,7 +149,34 @@ int main(void) {
 	//MX_USB_DEVICE_Init();
 	MX_TIM2_Init();
 	/* USER CODE BEGIN 2 */
-
+	TIMEBASE_Init();
+	EVENT_Init();
+	WATCHDOG_Init();
+	CRASH_Init();
+	SUPPLY_Init();
+	NVM_Init();
+	FAULT_Init();
+	LATCH_Init();
+	BATTERY_Init();
+	STATE_Init();
+	LIFETIME_Init();
+	STANDBY_Init();
+	CHARGER_Init();
+	EQUALIZE_Init();
+	OUTCHECK_Init();
+	PROTECT_Init();
+	POWER_Init();
+
+	/* Protection and acquisition preempt the rest; registration order is
+	   priority order within a level */
+	SCHED_Init();
+	SCHED_AddTask(TaskFaults, SCHED_LEVEL_PREEMPT, TASK_FAULTS_PERIOD, TASK_FAULTS_PHASE, TASK_FAULTS_BUDGET);
+	SCHED_AddTask(TaskFrame, SCHED_LEVEL_PREEMPT, TASK_FRAME_PERIOD, TASK_FRAME_PHASE, TASK_FRAME_BUDGET);
+	SCHED_AddTask(TaskControl, SCHED_LEVEL_BACKGROUND, TASK_CONTROL_PERIOD, TASK_CONTROL_PHASE, TASK_CONTROL_BUDGET);
+	SCHED_AddTask(TaskJournal, SCHED_LEVEL_BACKGROUND, TASK_JOURNAL_PERIOD, TASK_JOURNAL_PHASE, TASK_JOURNAL_BUDGET);
+	SCHED_AddTask(TaskComms, SCHED_LEVEL_BACKGROUND, TASK_COMMS_PERIOD, TASK_COMMS_PHASE, TASK_COMMS_BUDGET);
+	SCHED_AddTask(TaskHousekeeping, SCHED_LEVEL_BACKGROUND, TASK_HOUSEKEEPING_PERIOD, TASK_HOUSEKEEPING_PHASE, TASK_HOUSEKEEPING_BUDGET);
+	SCHED_Start();
 	/* USER CODE END 2 */
 
 	/* Infinite loop */
@@ -108,25 +185,14 @@ int main(void) {
 		/* USER CODE END WHILE */
 
 		/* USER CODE BEGIN 3 */
-		/* Process incoming commands */
-
-		/*/	if (commandReady) {
-		 ProcessCommand();
-		 commandReady = 0;
-		 }*/
-
-		ADC_ReadAll(systemState.voltages); // Read ADC directly
-		//systemState.batteryLevel = BATTERY_CalculateLevel(
-				//systemState.voltages[BANK_A]);
-
-		/* Update system state */
-		SYSTEM_Update();
+		/* Run the tasks released by the 1 ms scheduler tick */
+		SCHED_Run();
 
-		/* Check for faults */
-		FAULT_Check();
+		/* Refresh the IWDG while every task is on time */
+		WATCHDOG_Update();
 
-		/* Update battery state */
-		BATTERY_Update();
+		/* Sleep until the next tick, or Stop during long standby */
+		POWER_Idle();
 
 		/* Send periodic status if needed */
 		/*if (SYSTEM_ShouldSendStatus()) {
@@ -180,24 +246,108 @@ void SystemClock_Config(void) {
 }
 
 /* USER CODE BEGIN 4 */
+/**
+ * @brief  Scheduler task: apply fault events before anything acts on them
+ * @retval None
+ */
+static void TaskFaults(void) {
+	FAULT_Check();
+	LATCH_Update();
+	WATCHDOG_Checkin(WATCHDOG_TASK_PROTECTION);
+}
+
+/**
+ * @brief  Scheduler task: sample frame and the checks that act on it
+ * @retval None
+ */
+static void TaskFrame(void) {
+	ADC_ReadAll(systemState.voltages); // Read ADC directly
+	WATCHDOG_Checkin(WATCHDOG_TASK_ACQUISITION);
+
+	/* Update battery state on the fresh sample (low-voltage disconnect) */
+	BATTERY_Update();
+	WATCHDOG_Checkin(WATCHDOG_TASK_BATTERY);
+
+	/* Evaluate the voltage protection rules on the same frame */
+	PROTECT_Update();
+}
+
+/**
+ * @brief  Scheduler task: charge control, outputs and system state
+ * @retval None
+ */
+static void TaskControl(void) {
+	/* End the charge phase on plateau, -dV or timeout */
+	CHARGER_Update();
+
+	/* Run the periodic equalization charge */
+	EQUALIZE_Update();
+
+	/* Update system state */
+	SYSTEM_Update();
+
+	/* Read the enables back against their command and LOAD */
+	OUTCHECK_Update();
+
+	/* Derive system state */
+	STATE_Update();
+
+	/* Keep the emergency record current for a supply drop */
+	SUPPLY_Update();
+}
+
+/**
+ * @brief  Scheduler task: journal pending events to flash, one bounded step
+ * @retval None
+ */
+static void TaskJournal(void) {
+	EVENT_Update();
+}
+
+/**
+ * @brief  Scheduler task: process incoming commands
+ * @retval None
+ */
+static void TaskComms(void) {
+	if (commandReady) {
+		ProcessCommand();
+		commandReady = 0;
+	}
+	WATCHDOG_Checkin(WATCHDOG_TASK_COMMS);
+}
+
+/**
+ * @brief  Scheduler task: slow statistics
+ * @retval None
+ */
+static void TaskHousekeeping(void) {
+	/* Accumulate lifetime statistics */
+	LIFETIME_Update();
+
+	/* Track standby self-discharge */
+	STANDBY_Update();
+}
+
 // Add this to main.c in the ProcessCommand function
 /**
  * @brief  Process received command from USB
  * @note   Parse and execute commands from the PC application
  * @retval None
  */
-/*
 void ProcessCommand(void) {
 	char cmd = receiveBuffer[0];
 
 	switch (cmd) {
-	case 'S': // Status request
-		// Update all values and send status
-		ADC_ReadAll(systemState.voltages);
-		systemState.batteryLevel = BATTERY_CalculateLevel(
-				systemState.voltages[BANK_A]);
-		//USB_SendStatus(&systemState);
+	case 'S': { // Status request
+		// Latest frame of the frame task, copied whole so it is not torn
+		uint32_t key = SCHED_Lock();
+		SystemState_t status = systemState;
+		SCHED_Unlock(key);
+		status.batteryLevel = BATTERY_CalculateLevel(status.voltages[BANK_A]);
+		systemState.batteryLevel = status.batteryLevel;
+		USB_SendStatus(&status);
 		break;
+	}
 
 	case 'L': // LED control (L0-5)(0-1)
 		if (receiveBuffer[1] >= '0' && receiveBuffer[1] <= '5'
@@ -238,11 +388,126 @@ void ProcessCommand(void) {
 		}
 		break;
 
+	case 'O': // Lifetime statistics (odometer)
+		USB_SendLifetimeStats(LIFETIME_GetStats());
+		break;
+
+	case 'M': // State machine transition statistics
+		USB_SendStateStats(STATE_GetStats());
+		break;
+
+	case 'D': // Standby drain rate history
+		USB_SendDrainHistory(STANDBY_GetHistory());
+		break;
+
+	case 'Q': // Equalization status, start (Q1) or abort (Q0)
+		if (receiveBuffer[1] >= '0' && receiveBuffer[1] <= '1') {
+			EQUALIZE_Request(receiveBuffer[1] - '0');
+		}
+		USB_SendEqualizeStatus(EQUALIZE_GetStatus());
+		break;
+
+	case 'F': // Fault line pulse and cutoff statistics
+		USB_SendFaultLineStats(FAULT_GetLineStats(), FAULT_GetQueueStats());
+		break;
+
+	case 'K': // Latched fault status, clear all (KC) or one line (K0-3)
+		if (receiveBuffer[1] == 'C') {
+			FAULT_ClearLatched(FAULT_BLOCK_200A | FAULT_BLOCK_100A | FAULT_CHARGE | FAULT_FAST_CHARGE);
+		} else if (receiveBuffer[1] >= '0' && receiveBuffer[1] <= '3') {
+			FAULT_ClearLatched(1 << (receiveBuffer[1] - '0'));
+		}
+		USB_SendLatchStatus(FAULT_GetState(), FAULT_GetLockedLines(), FAULT_GetLineStats());
+		break;
+
+	case 'G': // Event journal chunk (G<n>) or clear (GC)
+		if (receiveBuffer[1] == 'C') {
+			EVENT_ClearJournal();
+			USB_SendJournalChunk(0);
+		} else {
+			uint16_t chunk = 0;
+			for (uint8_t i = 1; receiveBuffer[i] >= '0' && receiveBuffer[i] <= '9'; i++) {
+				chunk = chunk * 10 + (receiveBuffer[i] - '0');
+			}
+			USB_SendJournalChunk(chunk);
+		}
+		break;
+
+	case 'W': // Watchdog reset report and task liveness
+		USB_SendWatchdogStatus(WATCHDOG_GetStatus());
+		break;
+
+	case 'X': // Crash report (X) or clear (XC)
+		if (receiveBuffer[1] == 'C') {
+			CRASH_Clear();
+		}
+		USB_SendCrashReport(CRASH_GetReport());
+		break;
+
+	case 'V': // Last emergency record saved on a supply drop
+		USB_SendSupplyRecord(SUPPLY_GetLastRecord(), SUPPLY_GetFreeSlots());
+		break;
+
+	case 'A': // Relay actuation statistics and feedback position
+		USB_SendLatchRelayStats(LATCH_GetStats());
+		break;
+
+	case 'H': // Output self-check counters (H) or clear FAULT_OUTPUT (HC)
+		if (receiveBuffer[1] == 'C') {
+			OUTCHECK_Clear();
+		}
+		USB_SendOutputCheckStats(OUTCHECK_GetStats());
+		break;
+
+	case 'N': // Per-line fault history (binary frame)
+		USB_SendFaultHistory(FAULT_GetHistory());
+		break;
+
+	case 'Z': // Snapshots of the latest latched faults (binary frame)
+		USB_SendFaultSnapshots(FAULT_GetSnapshots());
+		break;
+
+	case 'I': // Low-power residency and wake counts
+		USB_SendPowerStatus(POWER_GetStatus());
+		break;
+
+	case 'J': // Scheduler task timing, budgets and overruns
+		USB_SendSchedulerStatus(SCHED_GetStatus());
+		break;
+
+	case 'U': // Protection rules (U), restore defaults (UD) or set one (US<i>,ch,dir,mV,hyst,q,r,act)
+		if (receiveBuffer[1] == 'D') {
+			PROTECT_RestoreDefaults();
+		} else if (receiveBuffer[1] == 'S') {
+			uint32_t fields[8] = {0};
+			uint8_t field = 0;
+			for (uint8_t i = 2; receiveBuffer[i] != 0 && field < 8; i++) {
+				if (receiveBuffer[i] == ',') {
+					field++;
+				} else if (receiveBuffer[i] >= '0' && receiveBuffer[i] <= '9') {
+					fields[field] = fields[field] * 10 + (receiveBuffer[i] - '0');
+				}
+			}
+			if (field == 7 && fields[0] < PROTECT_MAX_RULES) {
+				ProtectRule_t rule = {
+					.channel = (uint8_t)fields[1],
+					.direction = (uint8_t)fields[2],
+					.actions = (uint8_t)fields[7],
+					.thresholdMv = (uint16_t)fields[3],
+					.hysteresisMv = (uint16_t)fields[4],
+					.qualifyMs = (uint16_t)fields[5],
+					.releaseMs = (uint16_t)fields[6]
+				};
+				PROTECT_SetRule((uint8_t)fields[0], &rule);
+			}
+		}
+		USB_SendProtectionStatus(PROTECT_GetConfig(), PROTECT_GetStatus());
+		break;
+
 	default:
 		break;
 	}
 }
-*/
 
 /**
  * @brief  USB CDC Received data callback
@@ -251,14 +516,13 @@ void ProcessCommand(void) {
  * @param  length: Number of received bytes
  * @retval None
  */
-/*void USB_DataReceived(uint8_t* buffer, uint32_t length)
- {
- if (length > 0 && length < sizeof(receiveBuffer)) {
- memcpy(receiveBuffer, buffer, length);
- receiveBuffer[length] = 0; // Null-terminate
- commandReady = 1;
- }
- }*/
+void USB_DataReceived(uint8_t* buffer, uint32_t length) {
+	if (length > 0 && length < sizeof(receiveBuffer)) {
+		memcpy(receiveBuffer, buffer, length);
+		receiveBuffer[length] = 0; // Null-terminate
+		commandReady = 1;
+	}
+}
 
 /**
  * @brief  Timer elapsed callback
@@ -270,6 +534,7 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
 	if (htim->Instance == TIM2) {
 		// 1ms timer for system timing
 		SYSTEM_TimerTick();
+		SCHED_TickFromISR();
 	}
 }
 
@@ -280,15 +545,8 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
  * @retval None
  */
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
-	if (GPIO_Pin == FLT_BLOCK_100A_Pin) {
-		FAULT_SetFaultFlag(FAULT_BLOCK_100A);
-	} else if (GPIO_Pin == FLT_BLOCK_200A_Pin) {
-		FAULT_SetFaultFlag(FAULT_BLOCK_200A);
-	} else if (GPIO_Pin == FLT_CHARGE_Pin) {
-		FAULT_SetFaultFlag(FAULT_CHARGE);
-	} else if (GPIO_Pin == FLT_FAST_CHARGE_Pin) {
-		FAULT_SetFaultFlag(FAULT_FAST_CHARGE);
-	}
+	// Outputs were already cut in FAULT_CutoffFromISR, qualified on SysTick
+	FAULT_EdgeFromISR(GPIO_Pin);
 }
 /* USER CODE END 4 */
 
@@ -300,8 +558,7 @@ void Error_Handler(void) {
 	/* USER CODE BEGIN Error_Handler_Debug */
 	/* User can add his own implementation to report the HAL error return state */
 	__disable_irq();
-	while (1) {
-	}
+	CRASH_FromError((uint32_t)__builtin_return_address(0));
 	/* USER CODE END Error_Handler_Debug */
 }
 
@@ -0,0 +1,300 @@
+/**
+  ******************************************************************************
+  * @file    nvm_storage.c
+  * @brief   Non-volatile record storage module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  *
+  * Records are appended to the active bank as
+  *   [tag:8 | length:8 | checksum:16][payload, padded to 4 bytes]
+  * behind a 32-bit bank sequence number at the start of the bank. Updating a
+  * tag never rewrites flash in place; the latest valid record wins. When the
+  * active bank is full, the latest record of every tag is copied to the other
+  * bank, whose sequence number is written last so an interrupted copy leaves
+  * the old bank in charge. Both banks are therefore erased alternately.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "nvm_storage.h"
+#include "scheduler.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define NVM_ERASED_WORD      0xFFFFFFFFUL
+#define NVM_HEADER_SIZE      4U
+#define NVM_RECORD_SIZE(len) (NVM_HEADER_SIZE + (((uint32_t)(len) + 3U) & ~3U))
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t activeBank = 0;    // Address of the active bank, 0 if none
+static uint32_t bankSequence = 0;  // Sequence number of the active bank
+static uint32_t nextAddress = 0;   // First free address in the active bank
+
+/* Private function prototypes -----------------------------------------------*/
+static uint16_t Checksum(uint8_t tag, const uint8_t* data, uint16_t length);
+static uint32_t ScanBank(uint8_t tag, uint16_t* length, uint32_t* freeAddress);
+static uint8_t ProgramBytes(uint32_t address, const uint8_t* data, uint16_t length);
+static uint8_t ProgramRecord(uint32_t address, uint8_t tag, const uint8_t* data, uint16_t length);
+static uint8_t CompactBank(void);
+
+/**
+  * @brief  Initialize the record store and locate the active bank
+  * @retval None
+  */
+void NVM_Init(void)
+{
+  uint32_t sequence0 = *(volatile uint32_t*)NVM_RECORD_BANK_0;
+  uint32_t sequence1 = *(volatile uint32_t*)NVM_RECORD_BANK_1;
+
+  activeBank = 0;
+  bankSequence = 0;
+  nextAddress = 0;
+
+  // Pick the bank with the newest sequence number
+  if (sequence0 != NVM_ERASED_WORD &&
+      (sequence1 == NVM_ERASED_WORD || (int32_t)(sequence0 - sequence1) > 0)) {
+    activeBank = NVM_RECORD_BANK_0;
+    bankSequence = sequence0;
+  } else if (sequence1 != NVM_ERASED_WORD) {
+    activeBank = NVM_RECORD_BANK_1;
+    bankSequence = sequence1;
+  }
+
+  if (activeBank != 0) {
+    ScanBank(NVM_TAG_NONE, NULL, &nextAddress);
+  }
+}
+
+/**
+  * @brief  Read the latest record stored under a tag
+  * @param  tag: Record tag (NvmTagEnum)
+  * @param  data: Buffer to store the record payload
+  * @param  length: Expected payload length in bytes
+  * @retval 1 if a valid record of that length was found, 0 otherwise
+  */
+uint8_t NVM_Read(uint8_t tag, void* data, uint16_t length)
+{
+  uint16_t storedLength = 0;
+  uint32_t address;
+
+  if (activeBank == 0 || tag == NVM_TAG_NONE || tag >= NVM_TAG_COUNT) {
+    return 0;
+  }
+
+  address = ScanBank(tag, &storedLength, NULL);
+
+  // A layout change of the payload invalidates the stored record
+  if (address == 0 || storedLength != length) {
+    return 0;
+  }
+
+  const uint8_t* source = (const uint8_t*)address;
+  uint8_t* destination = (uint8_t*)data;
+  for (uint16_t i = 0; i < length; i++) {
+    destination[i] = source[i];
+  }
+
+  return 1;
+}
+
+/**
+  * @brief  Append a new record for a tag
+  * @note   Blocks while programming; when the active bank is full the latest
+  *         record of every tag is copied to the other bank first (page erase).
+  * @param  tag: Record tag (NvmTagEnum)
+  * @param  data: Record payload
+  * @param  length: Payload length in bytes (max NVM_RECORD_MAX_LENGTH)
+  * @retval 1 on success, 0 on flash error
+  */
+uint8_t NVM_Write(uint8_t tag, const void* data, uint16_t length)
+{
+  uint32_t size = NVM_RECORD_SIZE(length);
+  uint8_t ok = 1;
+
+  if (tag == NVM_TAG_NONE || tag >= NVM_TAG_COUNT || length > NVM_RECORD_MAX_LENGTH) {
+    return 0;
+  }
+
+  // Both scheduler levels store records; flash fetches stall during the
+  // erase and programming anyway, so the lock adds no latency of its own
+  uint32_t key = SCHED_Lock();
+  HAL_FLASH_Unlock();
+
+  // Move to the other bank when the record does not fit
+  if (activeBank == 0 || nextAddress + size > activeBank + NVM_RECORD_BANK_SIZE) {
+    ok = CompactBank();
+  }
+
+  if (ok && nextAddress + size <= activeBank + NVM_RECORD_BANK_SIZE) {
+    ok = ProgramRecord(nextAddress, tag, (const uint8_t*)data, length);
+    nextAddress += size;
+  } else {
+    ok = 0;
+  }
+
+  HAL_FLASH_Lock();
+  SCHED_Unlock(key);
+
+  return ok;
+}
+
+/**
+  * @brief  Fletcher-16 checksum over tag, length and payload
+  * @param  tag: Record tag
+  * @param  data: Record payload
+  * @param  length: Payload length in bytes
+  * @retval Checksum value
+  */
+static uint16_t Checksum(uint8_t tag, const uint8_t* data, uint16_t length)
+{
+  uint16_t sum1 = tag;
+  uint16_t sum2 = tag;
+
+  sum1 = (sum1 + length) % 255;
+  sum2 = (sum2 + sum1) % 255;
+
+  for (uint16_t i = 0; i < length; i++) {
+    sum1 = (sum1 + data[i]) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+
+  return (uint16_t)((sum2 << 8) | sum1);
+}
+
+/**
+  * @brief  Walk the records of the active bank
+  * @param  tag: Tag to look for (NVM_TAG_NONE to only find the free space)
+  * @param  length: Pointer to store the payload length of the match (may be NULL)
+  * @param  freeAddress: Pointer to store the first free address (may be NULL)
+  * @retval Payload address of the latest valid record of the tag, 0 if none
+  */
+static uint32_t ScanBank(uint8_t tag, uint16_t* length, uint32_t* freeAddress)
+{
+  uint32_t address = activeBank + NVM_HEADER_SIZE;
+  uint32_t end = activeBank + NVM_RECORD_BANK_SIZE;
+  uint32_t found = 0;
+
+  while (address + NVM_HEADER_SIZE <= end) {
+    uint32_t header = *(volatile uint32_t*)address;
+    if (header == NVM_ERASED_WORD) {
+      break;
+    }
+
+    uint8_t recordTag = header & 0xFF;
+    uint16_t recordLength = (header >> 8) & 0xFF;
+    uint32_t size = NVM_RECORD_SIZE(recordLength);
+
+    // Corrupted header: treat the rest of the bank as used
+    if (address + size > end) {
+      address = end;
+      break;
+    }
+
+    if (recordTag == tag && tag != NVM_TAG_NONE &&
+        (header >> 16) == Checksum(recordTag, (const uint8_t*)(address + NVM_HEADER_SIZE), recordLength)) {
+      found = address + NVM_HEADER_SIZE;
+      if (length != NULL) {
+        *length = recordLength;
+      }
+    }
+
+    address += size;
+  }
+
+  if (freeAddress != NULL) {
+    *freeAddress = address;
+  }
+
+  return found;
+}
+
+/**
+  * @brief  Program a byte buffer as flash half-words
+  * @param  address: Flash address (half-word aligned)
+  * @param  data: Data to program
+  * @param  length: Number of bytes
+  * @retval 1 on success, 0 on flash error
+  */
+static uint8_t ProgramBytes(uint32_t address, const uint8_t* data, uint16_t length)
+{
+  for (uint16_t i = 0; i < length; i += 2) {
+    uint16_t halfWord = data[i];
+    halfWord |= (uint16_t)(((i + 1) < length) ? data[i + 1] : 0xFF) << 8;
+
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, address + i, halfWord) != HAL_OK) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Program one record (header first, so a torn write fails its checksum)
+  * @param  address: Record address in the active bank
+  * @param  tag: Record tag
+  * @param  data: Record payload
+  * @param  length: Payload length in bytes
+  * @retval 1 on success, 0 on flash error
+  */
+static uint8_t ProgramRecord(uint32_t address, uint8_t tag, const uint8_t* data, uint16_t length)
+{
+  uint16_t checksum = Checksum(tag, data, length);
+
+  if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, address, (uint16_t)(tag | (length << 8))) != HAL_OK ||
+      HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, address + 2, checksum) != HAL_OK) {
+    return 0;
+  }
+
+  return ProgramBytes(address + NVM_HEADER_SIZE, data, length);
+}
+
+/**
+  * @brief  Copy the latest record of every tag into the other bank
+  * @note   Flash must be unlocked by the caller
+  * @retval 1 on success, 0 on flash error
+  */
+static uint8_t CompactBank(void)
+{
+  uint32_t target = (activeBank == NVM_RECORD_BANK_0) ? NVM_RECORD_BANK_1 : NVM_RECORD_BANK_0;
+  uint32_t address = target + NVM_HEADER_SIZE;
+  FLASH_EraseInitTypeDef eraseInit = {0};
+  uint32_t pageError = 0;
+
+  eraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
+  eraseInit.PageAddress = target;
+  eraseInit.NbPages = NVM_RECORD_BANK_SIZE / FLASH_PAGE_SIZE;
+  if (HAL_FLASHEx_Erase(&eraseInit, &pageError) != HAL_OK) {
+    return 0;
+  }
+
+  // Carry over the current value of every tag
+  if (activeBank != 0) {
+    for (uint8_t tag = NVM_TAG_NONE + 1; tag < NVM_TAG_COUNT; tag++) {
+      uint16_t length = 0;
+      uint32_t source = ScanBank(tag, &length, NULL);
+      if (source != 0) {
+        if (!ProgramRecord(address, tag, (const uint8_t*)source, length)) {
+          return 0;
+        }
+        address += NVM_RECORD_SIZE(length);
+      }
+    }
+  }
+
+  // Commit the new bank by writing its sequence number last
+  uint32_t sequence = bankSequence + 1;
+  if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, target, sequence) != HAL_OK) {
+    return 0;
+  }
+
+  activeBank = target;
+  bankSequence = sequence;
+  nextAddress = address;
+
+  return 1;
+}
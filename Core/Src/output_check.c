@@ -0,0 +1,238 @@
+/**
+  ******************************************************************************
+  * @file    output_check.c
+  * @brief   Enable output readback self-check module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "output_check.h"
+#include "system_control.h"
+#include "fault_handling.h"
+#include "event_log.h"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+  GPIO_TypeDef* port;
+  uint16_t pin;
+} OutputPin_t;
+
+/* Private constants ---------------------------------------------------------*/
+static const OutputPin_t outputPins[OUTCHECK_SIGNAL_COUNT] = {
+  { EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin },
+  { EN_CHARGE_GPIO_Port,      EN_CHARGE_Pin },
+  { EN_BLOCK_100A_GPIO_Port,  EN_BLOCK_100A_Pin },
+  { EN_BLOCK_200A_GPIO_Port,  EN_BLOCK_200A_Pin },
+};
+
+#define OUTCHECK_BLOCK_100A  2   // outputPins index of the block enables
+#define OUTCHECK_BLOCK_200A  3
+
+/* Private variables ---------------------------------------------------------*/
+static OutputCheckStats_t stats;
+static uint32_t lastCheckTime = 0;
+static uint8_t gpioPersist[OUTCHECK_SIGNAL_COUNT];
+static uint8_t loadPersist = 0;
+static uint8_t blocksOn = 0;        // Block enables read back on at the last check
+static uint32_t blocksChangedAt = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t CheckPins(void);
+static uint8_t CheckLoad(uint8_t odrBits);
+static void Fail(uint8_t bits);
+
+/**
+  * @brief  Initialize the output self-check
+  * @retval None
+  */
+void OUTCHECK_Init(void)
+{
+  uint8_t* raw = (uint8_t*)&stats;
+  for (uint16_t i = 0; i < sizeof(stats); i++) {
+    raw[i] = 0;
+  }
+  for (uint8_t i = 0; i < OUTCHECK_SIGNAL_COUNT; i++) {
+    gpioPersist[i] = 0;
+  }
+
+  loadPersist = 0;
+  blocksOn = 0;
+  lastCheckTime = HAL_GetTick();
+  blocksChangedAt = lastCheckTime;
+}
+
+/**
+  * @brief  Compare the enable outputs with their command and the LOAD voltage
+  * @note   Call after SYSTEM_Update so the outputs were just written
+  * @retval None
+  */
+void OUTCHECK_Update(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+
+  if (currentTime - lastCheckTime < OUTCHECK_INTERVAL) {
+    return;
+  }
+  lastCheckTime = currentTime;
+  stats.checks++;
+
+  uint8_t odrBits = CheckPins();
+  uint8_t failed = CheckLoad(odrBits);
+
+  for (uint8_t i = 0; i < OUTCHECK_SIGNAL_COUNT; i++) {
+    if (gpioPersist[i] >= OUTCHECK_GPIO_PERSIST) {
+      failed |= (uint8_t)(1 << i);
+    }
+  }
+
+  if (failed & ~stats.failed) {
+    Fail(failed & ~stats.failed);
+  }
+}
+
+/**
+  * @brief  Clear FAULT_OUTPUT and the persistent mismatches
+  * @note   Counters are kept; a mismatch still present raises the fault again
+  * @retval None
+  */
+void OUTCHECK_Clear(void)
+{
+  for (uint8_t i = 0; i < OUTCHECK_SIGNAL_COUNT; i++) {
+    gpioPersist[i] = 0;
+  }
+  loadPersist = 0;
+  stats.failed = 0;
+  FAULT_ClearFaultFlag(FAULT_OUTPUT);
+}
+
+/**
+  * @brief  Get self-check counters
+  * @retval Pointer to the counters
+  */
+const OutputCheckStats_t* OUTCHECK_GetStats(void)
+{
+  return &stats;
+}
+
+/**
+  * @brief  Read back every enable and count ODR and IDR mismatches
+  * @retval ODR state of the enables (bit per signal index)
+  */
+static uint8_t CheckPins(void)
+{
+  uint8_t odrBits = 0;
+  uint16_t expected[2];
+  uint16_t odr[2];
+  uint16_t idr[2];
+  uint32_t primask = __get_PRIMASK();
+
+  // One consistent snapshot against the fault cutoff ISR
+  __disable_irq();
+  expected[0] = SYSTEM_GetCommandedOutputs(GPIOA) & ~FAULT_GetBlockedOutputs(GPIOA);
+  expected[1] = SYSTEM_GetCommandedOutputs(GPIOB) & ~FAULT_GetBlockedOutputs(GPIOB);
+  odr[0] = (uint16_t)GPIOA->ODR;
+  odr[1] = (uint16_t)GPIOB->ODR;
+  idr[0] = (uint16_t)GPIOA->IDR;
+  idr[1] = (uint16_t)GPIOB->IDR;
+  __set_PRIMASK(primask);
+
+  for (uint8_t i = 0; i < OUTCHECK_SIGNAL_COUNT; i++) {
+    uint8_t port = outputPins[i].port == GPIOB;
+    uint16_t pin = outputPins[i].pin;
+    uint8_t mismatch = 0;
+
+    if ((odr[port] ^ expected[port]) & pin) {
+      stats.odrMismatches[i]++;
+      mismatch = 1;
+    }
+    if ((idr[port] ^ odr[port]) & pin) {
+      stats.idrMismatches[i]++;
+      mismatch = 1;
+    }
+
+    if (!mismatch) {
+      gpioPersist[i] = 0;
+    } else if (gpioPersist[i] < OUTCHECK_GPIO_PERSIST) {
+      gpioPersist[i]++;
+    }
+
+    if (odr[port] & pin) {
+      odrBits |= (uint8_t)(1 << i);
+    }
+  }
+
+  return odrBits;
+}
+
+/**
+  * @brief  Judge the LOAD voltage against the block enables
+  * @param  odrBits: ODR state of the enables (bit per signal index)
+  * @retval OutputCheckFailEnum bit of a persistent mismatch, 0 otherwise
+  */
+static uint8_t CheckLoad(uint8_t odrBits)
+{
+  const uint8_t blockBits = (1 << OUTCHECK_BLOCK_100A) | (1 << OUTCHECK_BLOCK_200A);
+  uint8_t on;
+  float bank = systemState.voltages[BANK_A];
+
+  // Only both blocks on or both off give a defined LOAD expectation
+  if ((odrBits & blockBits) == blockBits) {
+    on = 1;
+  } else if ((odrBits & blockBits) == 0) {
+    on = 0;
+  } else {
+    loadPersist = 0;
+    blocksChangedAt = HAL_GetTick();
+    return 0;
+  }
+
+  if (on != blocksOn) {
+    blocksOn = on;
+    blocksChangedAt = HAL_GetTick();
+  }
+
+  if (systemState.voltages[BANK_B] > bank) {
+    bank = systemState.voltages[BANK_B];
+  }
+  if (HAL_GetTick() - blocksChangedAt < OUTCHECK_SETTLE_TIME || bank < OUTCHECK_LOAD_MIN_BANK) {
+    loadPersist = 0;
+    return 0;
+  }
+
+  uint8_t mismatch = 0;
+  if (on && systemState.voltages[LOAD] < bank * OUTCHECK_LOAD_ON_RATIO) {
+    stats.loadOnMismatches++;
+    mismatch = OUTCHECK_FAIL_LOAD_ON;
+  } else if (!on && systemState.voltages[LOAD] > OUTCHECK_LOAD_OFF_VOLTAGE) {
+    stats.loadOffMismatches++;
+    mismatch = OUTCHECK_FAIL_LOAD_OFF;
+  }
+
+  if (!mismatch) {
+    loadPersist = 0;
+    return 0;
+  }
+  if (loadPersist < OUTCHECK_LOAD_PERSIST) {
+    loadPersist++;
+  }
+  return loadPersist >= OUTCHECK_LOAD_PERSIST ? mismatch : 0;
+}
+
+/**
+  * @brief  Raise FAULT_OUTPUT for new persistent mismatches
+  * @param  bits: Newly failed signal and OutputCheckFailEnum bits
+  * @retval None
+  */
+static void Fail(uint8_t bits)
+{
+  stats.failed |= bits;
+  stats.faultsRaised++;
+  FAULT_SetFaultFlag(FAULT_OUTPUT);
+  EVENT_Post(EVENT_OUTPUT_CHECK, bits, stats.failed);
+}
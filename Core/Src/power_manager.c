@@ -0,0 +1,388 @@
+/**
+  ******************************************************************************
+  * @file    power_manager.c
+  * @brief   Low-power idle module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "power_manager.h"
+#include "scheduler.h"
+#include "timebase.h"
+#include "watchdog.h"
+#include "state_machine.h"
+#include "fault_handling.h"
+#include "system_control.h"
+#include "latch_relay.h"
+#include "usb_com.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* RTC register access (no HAL RTC driver in this project) */
+#define RTC_SYNC_TIMEOUT     5    // ms to wait for an RTC register write or resync
+#define LSI_START_TIMEOUT    5    // ms to wait for the LSI
+#define RTC_ALARM_PRIORITY   15   // Only wakes the core, nothing runs in its handler
+
+/* Private variables ---------------------------------------------------------*/
+static PowerStatus_t status;
+static volatile uint8_t alarmFired = 0;
+static uint32_t sleepCycles = 0;   // Sleep cycles not counted in sleepMs yet
+static uint32_t awakeSince = 0;    // Tick of the last wake from Stop
+static uint32_t awakeFor = 0;      // ms to stay out of Stop after awakeSince
+static uint32_t segmentRtc = 0;    // RTC count at the start of the awake segment
+static uint32_t segmentTick = 0;   // Tick at the start of the awake segment
+static uint32_t calRtc = 0;        // RTC counts seen over calMs of awake time
+static uint32_t calMs = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t IsStopAllowed(void);
+static void EnterSleep(void);
+static void EnterStop(void);
+static void Calibrate(uint32_t rtc, uint32_t tick);
+static uint32_t RtcCounter(void);
+static uint8_t RtcSync(void);
+static uint8_t RtcWaitWrite(void);
+static uint8_t RtcSetAlarm(uint32_t alarm);
+
+/**
+  * @brief  Start the RTC on the LSI for the Stop mode alarm
+  * @note   WATCHDOG_Init must have been called (backup domain access)
+  * @retval None
+  */
+void POWER_Init(void)
+{
+  uint8_t* raw = (uint8_t*)&status;
+  for (uint16_t i = 0; i < sizeof(status); i++) {
+    raw[i] = 0;
+  }
+  status.rtcPerSecond = POWER_RTC_NOMINAL;
+  status.lastMode = POWER_MODE_RUN;
+
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_RCC_BKP_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+
+  // The LSI normally runs for the IWDG already
+  __HAL_RCC_LSI_ENABLE();
+  uint32_t start = HAL_GetTick();
+  while (!__HAL_RCC_GET_FLAG(RCC_FLAG_LSIRDY)) {
+    if (HAL_GetTick() - start > LSI_START_TIMEOUT) {
+      return;
+    }
+  }
+
+  // The RTC clock can only be selected once per backup domain reset; a
+  // source other than the LSI is left alone and Stop mode is not used
+  if (__HAL_RCC_GET_RTC_SOURCE() == RCC_RTCCLKSOURCE_NO_CLK) {
+    __HAL_RCC_RTC_CONFIG(RCC_RTCCLKSOURCE_LSI);
+  }
+  if (__HAL_RCC_GET_RTC_SOURCE() != RCC_RTCCLKSOURCE_LSI) {
+    return;
+  }
+  __HAL_RCC_RTC_ENABLE();
+
+  if (!RtcSync() || !RtcWaitWrite()) {
+    return;
+  }
+  RTC->CRL |= RTC_CRL_CNF;
+  RTC->PRLH = 0;
+  RTC->PRLL = POWER_RTC_PRESCALER - 1;
+  RTC->ALRH = 0xFFFF;
+  RTC->ALRL = 0xFFFF;
+  RTC->CRL &= ~RTC_CRL_CNF;
+  if (!RtcWaitWrite()) {
+    return;
+  }
+
+  // The alarm reaches the NVIC through EXTI line 17, which also ends Stop
+  RTC->CRL &= ~RTC_CRL_ALRF;
+  RTC->CRH |= RTC_CRH_ALRIE;
+  EXTI->PR = EXTI_PR_PR17;
+  EXTI->RTSR |= EXTI_RTSR_TR17;
+  EXTI->IMR |= EXTI_IMR_MR17;
+  HAL_NVIC_SetPriority(RTC_Alarm_IRQn, RTC_ALARM_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(RTC_Alarm_IRQn);
+
+  segmentRtc = RtcCounter();
+  segmentTick = HAL_GetTick();
+  calRtc = 0;
+  calMs = 0;
+  status.stopReady = 1;
+}
+
+/**
+  * @brief  Sleep until the next interrupt, or Stop during long standby
+  * @note   Main loop only, after the scheduler pass
+  * @retval None
+  */
+void POWER_Idle(void)
+{
+  uint8_t stop = IsStopAllowed();
+
+  // Armed before interrupts are masked, the write waits on the RTC clock
+  if (stop && !RtcSetAlarm(RtcCounter() + POWER_STOP_PERIOD)) {
+    stop = 0;
+  }
+
+  // A tick after this check leaves its interrupt pending and WFI returns at once
+  __disable_irq();
+  if (!SCHED_IsIdle()) {
+    __enable_irq();
+    return;
+  }
+
+  if (stop) {
+    EnterStop();
+  } else {
+    EnterSleep();
+  }
+}
+
+/**
+  * @brief  Acknowledge the RTC alarm that ends a Stop
+  * @note   Called from the RTC alarm interrupt
+  * @retval None
+  */
+void POWER_AlarmFromISR(void)
+{
+  RTC->CRL &= ~RTC_CRL_ALRF;
+  EXTI->PR = EXTI_PR_PR17;
+  alarmFired = 1;
+}
+
+/**
+  * @brief  Get residency and wake counts
+  * @retval Pointer to the status
+  */
+const PowerStatus_t* POWER_GetStatus(void)
+{
+  return &status;
+}
+
+/**
+  * @brief  Check the conditions for Stop mode
+  * @retval 1 if the next idle period may use Stop mode
+  */
+static uint8_t IsStopAllowed(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+
+  if (!status.stopReady || currentTime - awakeSince < awakeFor) {
+    return 0;
+  }
+
+  if (systemState.state != STATE_STANDBY ||
+      currentTime - STATE_GetStats()->enteredAt[STATE_STANDBY] < POWER_STOP_HOLD_MS) {
+    return 0;
+  }
+
+  // Nothing switched on, nothing to report and no host to answer; a relay
+  // pulse is timed on SysTick, which stops with the clocks
+  return FAULT_GetState() == FAULT_NONE && FAULT_GetLockedLines() == 0 &&
+         !SYSTEM_IsPowerOutputOn() && SYSTEM_GetChargeMode() == CHARGE_OFF &&
+         !LATCH_IsBusy() && !USB_IsConfigured();
+}
+
+/**
+  * @brief  Wait in Sleep mode for the next interrupt
+  * @note   Called with interrupts disabled, enables them
+  * @retval None
+  */
+static void EnterSleep(void)
+{
+  uint32_t reload = SysTick->LOAD + 1;
+  uint32_t startCycles = DWT->CYCCNT;
+  uint32_t startValue = SysTick->VAL;
+
+  HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+
+  // SysTick counts down through Sleep and wakes the core at least once per
+  // reload; the DWT counter may not, so it gets the difference
+  uint32_t endValue = SysTick->VAL;
+  uint32_t slept = (endValue <= startValue) ? startValue - endValue :
+                   startValue + reload - endValue;
+  uint32_t counted = DWT->CYCCNT - startCycles;
+  if (slept > counted) {
+    TIMEBASE_Advance(slept - counted);
+  }
+  __enable_irq();
+
+  sleepCycles += slept;
+  status.sleepMs += sleepCycles / reload;
+  sleepCycles %= reload;
+  status.sleepWakes++;
+  status.lastMode = POWER_MODE_SLEEP;
+}
+
+/**
+  * @brief  Stop until the RTC alarm or a fault line, then restore the clocks
+  * @note   Called with interrupts disabled, enables them
+  * @retval None
+  */
+static void EnterStop(void)
+{
+  uint32_t startRtc = RtcCounter();
+  uint32_t startTick = uwTick;
+  uint32_t startCycles = DWT->CYCCNT;
+
+  Calibrate(startRtc, startTick);
+  SCHED_Suspend();
+  WATCHDOG_Update();
+  alarmFired = 0;
+
+  HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+
+  // The handler of the wake-up line runs first, still on the HSI
+  uint32_t wakeCycles = DWT->CYCCNT;
+  __enable_irq();
+  SystemClock_Config();
+
+  // Counted at the HSI rate the restore runs on, an upper bound
+  uint32_t restoreUs = (DWT->CYCCNT - wakeCycles) / (HSI_VALUE / 1000000);
+  status.lastRestoreUs = restoreUs > 0xFFFF ? 0xFFFF : (uint16_t)restoreUs;
+  if (status.lastRestoreUs > status.maxRestoreUs) {
+    status.maxRestoreUs = status.lastRestoreUs;
+  }
+
+  // Advance the HAL tick and the timebase by the time the RTC saw pass
+  uint32_t stoppedMs = 0;
+  if (RtcSync()) {
+    __disable_irq();
+    stoppedMs = (RtcCounter() - startRtc) * 1000 / status.rtcPerSecond;
+
+    uint32_t tickMs = uwTick - startTick;
+    if (stoppedMs > tickMs) {
+      uwTick += stoppedMs - tickMs;
+    }
+    uint32_t expected = stoppedMs * (SystemCoreClock / 1000);
+    uint32_t counted = DWT->CYCCNT - startCycles;
+    if (expected > counted) {
+      TIMEBASE_Advance(expected - counted);
+    }
+    __enable_irq();
+  } else {
+    // The RTC stopped answering, Stop mode is not safe to use any more
+    status.stopReady = 0;
+  }
+
+  SCHED_Resume();
+
+  status.stopMs += stoppedMs;
+  status.stopWakes++;
+  status.lastMode = POWER_MODE_STOP;
+  if (alarmFired) {
+    status.alarmWakes++;
+    awakeFor = POWER_STOP_AWAKE_MS;
+  } else {
+    awakeFor = POWER_WAKE_HOLD_MS;
+  }
+  awakeSince = HAL_GetTick();
+  segmentRtc = RtcCounter();
+  segmentTick = awakeSince;
+}
+
+/**
+  * @brief  Close the awake segment and update the RTC rate
+  * @param  rtc: RTC count at the end of the segment
+  * @param  tick: Tick at the end of the segment
+  * @retval None
+  */
+static void Calibrate(uint32_t rtc, uint32_t tick)
+{
+  calRtc += rtc - segmentRtc;
+  calMs += tick - segmentTick;
+
+  if (calMs >= POWER_CAL_SPAN_MS / 2) {
+    uint32_t rate = calRtc * 1000 / calMs;
+    // The LSI is specified from 30 to 60 kHz
+    if (rate >= POWER_RTC_NOMINAL * 3 / 4 && rate <= POWER_RTC_NOMINAL * 3 / 2) {
+      status.rtcPerSecond = (uint16_t)rate;
+    }
+  }
+
+  // Halve the history so the rate follows the LSI drift
+  if (calMs >= POWER_CAL_SPAN_MS) {
+    calRtc /= 2;
+    calMs /= 2;
+  }
+}
+
+/**
+  * @brief  Read the RTC counter
+  * @retval Counter value
+  */
+static uint32_t RtcCounter(void)
+{
+  uint16_t high = RTC->CNTH;
+  uint16_t low = RTC->CNTL;
+
+  // Read again if the low half carried between the two reads
+  if (RTC->CNTH != high) {
+    high = RTC->CNTH;
+    low = RTC->CNTL;
+  }
+  return ((uint32_t)high << 16) | low;
+}
+
+/**
+  * @brief  Wait until the RTC registers are synchronized to the APB clock
+  * @note   Needed after reset and after Stop mode before reading the counter
+  * @retval 1 on success, 0 on timeout
+  */
+static uint8_t RtcSync(void)
+{
+  uint32_t start = HAL_GetTick();
+
+  RTC->CRL &= ~RTC_CRL_RSF;
+  while (!(RTC->CRL & RTC_CRL_RSF)) {
+    if (HAL_GetTick() - start > RTC_SYNC_TIMEOUT) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Wait until the last RTC register write has completed
+  * @retval 1 on success, 0 on timeout
+  */
+static uint8_t RtcWaitWrite(void)
+{
+  uint32_t start = HAL_GetTick();
+
+  while (!(RTC->CRL & RTC_CRL_RTOFF)) {
+    if (HAL_GetTick() - start > RTC_SYNC_TIMEOUT) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Program the RTC alarm
+  * @param  alarm: Counter value the alarm fires at
+  * @retval 1 on success, 0 on timeout
+  */
+static uint8_t RtcSetAlarm(uint32_t alarm)
+{
+  if (!RtcWaitWrite()) {
+    status.stopReady = 0;
+    return 0;
+  }
+
+  RTC->CRL |= RTC_CRL_CNF;
+  RTC->ALRH = (uint16_t)(alarm >> 16);
+  RTC->ALRL = (uint16_t)alarm;
+  RTC->CRL &= ~RTC_CRL_CNF;
+
+  if (!RtcWaitWrite()) {
+    status.stopReady = 0;
+    return 0;
+  }
+  return 1;
+}
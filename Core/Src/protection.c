@@ -0,0 +1,308 @@
+/**
+  ******************************************************************************
+  * @file    protection.c
+  * @brief   Voltage protection rules module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "protection.h"
+#include "system_control.h"
+#include "battery_management.h"
+#include "latch_relay.h"
+#include "nvm_storage.h"
+#include "event_log.h"
+#include "scheduler.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define PROTECT_ACTION_MASK (PROTECT_ACTION_INHIBIT_CHARGE | PROTECT_ACTION_OPEN_OUTPUT | \
+                             PROTECT_ACTION_RELAY_RESET | PROTECT_ACTION_ALARM)
+
+/* Default table, used when no valid table is stored
+   (channel, direction, actions, reserved, threshold mV, hysteresis mV, qualify ms, release ms) */
+static const ProtectRule_t defaultRules[] = {
+  { LOAD,   PROTECT_ABOVE, PROTECT_ACTION_OPEN_OUTPUT | PROTECT_ACTION_ALARM,     0, 15500,  500,  500,  5000 },
+  { BANK_A, PROTECT_ABOVE, PROTECT_ACTION_INHIBIT_CHARGE | PROTECT_ACTION_ALARM,  0, 15000,  600, 1000, 10000 },
+  { BANK_B, PROTECT_ABOVE, PROTECT_ACTION_INHIBIT_CHARGE | PROTECT_ACTION_ALARM,  0, 15000,  600, 1000, 10000 },
+  { CHARGE, PROTECT_ABOVE, PROTECT_ACTION_INHIBIT_CHARGE | PROTECT_ACTION_ALARM,  0, 16000,  500,  200,  5000 },
+  { BANK_A, PROTECT_BELOW, PROTECT_ACTION_OPEN_OUTPUT | PROTECT_ACTION_ALARM,     0, 10500, 1000, 5000, 30000 },
+  { BANK_B, PROTECT_BELOW, PROTECT_ACTION_OPEN_OUTPUT | PROTECT_ACTION_ALARM,     0, 10500, 1000, 5000, 30000 },
+};
+
+/* Private variables ---------------------------------------------------------*/
+static ProtectConfig_t config;
+static ProtectStatus_t status;
+static uint16_t timing = 0;                    // Rule bits whose qualify or release timer runs
+static uint32_t timerStart[PROTECT_MAX_RULES]; // Tick the running timer started
+
+/* Private function prototypes -----------------------------------------------*/
+static void LoadDefaults(void);
+static uint8_t IsRuleValid(const ProtectRule_t* rule);
+static uint8_t IsConfigValid(void);
+static void ApplyActions(uint8_t actions);
+
+/**
+  * @brief  Initialize the protection engine and load the rule table
+  * @note   NVM_Init must have been called
+  * @retval None
+  */
+void PROTECT_Init(void)
+{
+  uint8_t* raw = (uint8_t*)&status;
+  for (uint16_t i = 0; i < sizeof(status); i++) {
+    raw[i] = 0;
+  }
+
+  if (!NVM_Read(NVM_TAG_PROTECT_RULES, &config, sizeof(config)) || !IsConfigValid()) {
+    LoadDefaults();
+    status.fromDefaults = 1;
+  }
+
+  timing = 0;
+}
+
+/**
+  * @brief  Evaluate every rule on the current sample frame and apply actions
+  * @retval None
+  */
+void PROTECT_Update(void)
+{
+  uint32_t startCycles = DWT->CYCCNT;
+  uint32_t currentTime = HAL_GetTick();
+  uint16_t frameMv[VOLTAGE_COUNT];
+  uint16_t tripped = 0;
+  uint8_t actions = 0;
+
+  // Convert the frame once so the rules are integer compares only
+  for (uint8_t ch = 0; ch < VOLTAGE_COUNT; ch++) {
+    float mv = systemState.voltages[ch] * 1000.0f;
+    if (mv < 0.0f) mv = 0.0f;
+    if (mv > 65535.0f) mv = 65535.0f;
+    frameMv[ch] = (uint16_t)mv;
+  }
+
+  for (uint8_t i = 0; i < config.count; i++) {
+    const ProtectRule_t* rule = &config.rules[i];
+    uint16_t bit = (uint16_t)(1 << i);
+    uint32_t mv = frameMv[rule->channel];
+    uint8_t reached;
+
+    if (rule->actions == 0) {
+      continue;
+    }
+
+    if (status.active & bit) {
+      // Tripped: wait for the channel to come back past the hysteresis
+      reached = (rule->direction == PROTECT_ABOVE) ?
+                (mv + rule->hysteresisMv < rule->thresholdMv) :
+                (mv > (uint32_t)rule->thresholdMv + rule->hysteresisMv);
+    } else {
+      reached = (rule->direction == PROTECT_ABOVE) ?
+                (mv > rule->thresholdMv) : (mv < rule->thresholdMv);
+    }
+
+    if (!reached) {
+      timing &= ~bit;
+    } else if (!(timing & bit)) {
+      timing |= bit;
+      timerStart[i] = currentTime;
+    }
+
+    if ((timing & bit) && currentTime - timerStart[i] >=
+        ((status.active & bit) ? rule->releaseMs : rule->qualifyMs)) {
+      timing &= ~bit;
+      status.active ^= bit;
+      if (status.active & bit) {
+        tripped |= bit;
+        if (status.trips < 0xFFFF) {
+          status.trips++;
+        }
+      }
+      EVENT_Post(EVENT_PROTECTION, i, (status.active & bit) ? 1 : 0);
+    }
+
+    if (status.active & bit) {
+      actions |= rule->actions;
+    }
+  }
+
+  status.lastCycles = DWT->CYCCNT - startCycles;
+  if (status.lastCycles > status.maxCycles) {
+    status.maxCycles = status.lastCycles;
+  }
+
+  ApplyActions(actions);
+
+  // One relay pulse is queued on the trip edge only
+  for (uint8_t i = 0; i < config.count; i++) {
+    if ((tripped & (1 << i)) && (config.rules[i].actions & PROTECT_ACTION_RELAY_RESET)) {
+      LATCH_Request(LATCH_POSITION_RESET);
+      break;
+    }
+  }
+}
+
+/**
+  * @brief  Replace one rule and store the table
+  * @param  index: Rule index (0 to PROTECT_MAX_RULES - 1)
+  * @param  rule: New rule
+  * @retval 1 on success, 0 if the rule is invalid or the write failed
+  */
+uint8_t PROTECT_SetRule(uint8_t index, const ProtectRule_t* rule)
+{
+  if (index >= PROTECT_MAX_RULES || !IsRuleValid(rule)) {
+    return 0;
+  }
+
+  // The table is evaluated on the preempting scheduler level
+  uint32_t key = SCHED_Lock();
+  config.rules[index] = *rule;
+  config.rules[index].reserved = 0;
+  if (index >= config.count) {
+    // Rules skipped over stay disabled
+    for (uint8_t i = config.count; i < index; i++) {
+      config.rules[i].actions = 0;
+    }
+    config.count = index + 1;
+  }
+
+  // The rule restarts from released
+  uint16_t bit = (uint16_t)(1 << index);
+  status.active &= ~bit;
+  timing &= ~bit;
+  status.fromDefaults = 0;
+  SCHED_Unlock(key);
+
+  return NVM_Write(NVM_TAG_PROTECT_RULES, &config, sizeof(config));
+}
+
+/**
+  * @brief  Restore and store the default rule table
+  * @retval 1 on success, 0 if the write failed
+  */
+uint8_t PROTECT_RestoreDefaults(void)
+{
+  uint32_t key = SCHED_Lock();
+  LoadDefaults();
+  status.active = 0;
+  status.fromDefaults = 1;
+  timing = 0;
+  SCHED_Unlock(key);
+
+  return NVM_Write(NVM_TAG_PROTECT_RULES, &config, sizeof(config));
+}
+
+/**
+  * @brief  Get the rule table in use
+  * @retval Pointer to the table
+  */
+const ProtectConfig_t* PROTECT_GetConfig(void)
+{
+  return &config;
+}
+
+/**
+  * @brief  Get the rule states and evaluation timing
+  * @retval Pointer to the status
+  */
+const ProtectStatus_t* PROTECT_GetStatus(void)
+{
+  return &status;
+}
+
+/**
+  * @brief  Load the default rule table from flash
+  * @retval None
+  */
+static void LoadDefaults(void)
+{
+  const uint8_t defaultCount = sizeof(defaultRules) / sizeof(defaultRules[0]);
+
+  config.count = defaultCount;
+  config.version = PROTECT_CONFIG_VERSION;
+  config.reserved = 0;
+  for (uint8_t i = 0; i < PROTECT_MAX_RULES; i++) {
+    if (i < defaultCount) {
+      config.rules[i] = defaultRules[i];
+    } else {
+      ProtectRule_t* rule = &config.rules[i];
+      rule->channel = 0;
+      rule->direction = 0;
+      rule->actions = 0;
+      rule->reserved = 0;
+      rule->thresholdMv = 0;
+      rule->hysteresisMv = 0;
+      rule->qualifyMs = 0;
+      rule->releaseMs = 0;
+    }
+  }
+}
+
+/**
+  * @brief  Check the fields of a rule
+  * @param  rule: Rule to check
+  * @retval 1 if the rule can be evaluated
+  */
+static uint8_t IsRuleValid(const ProtectRule_t* rule)
+{
+  return rule->channel < VOLTAGE_COUNT &&
+         rule->direction <= PROTECT_BELOW &&
+         (rule->actions & ~PROTECT_ACTION_MASK) == 0;
+}
+
+/**
+  * @brief  Check the table read from flash
+  * @retval 1 if the table can be used
+  */
+static uint8_t IsConfigValid(void)
+{
+  if (config.version != PROTECT_CONFIG_VERSION || config.count > PROTECT_MAX_RULES) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < config.count; i++) {
+    if (!IsRuleValid(&config.rules[i])) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Apply the combined actions of the tripped rules
+  * @param  actions: ProtectActionEnum bits
+  * @retval None
+  */
+static void ApplyActions(uint8_t actions)
+{
+  uint8_t changed = actions ^ status.actions;
+
+  if (changed & PROTECT_ACTION_INHIBIT_CHARGE) {
+    SYSTEM_SetChargeInhibit(INHIBIT_PROTECTION, (actions & PROTECT_ACTION_INHIBIT_CHARGE) ? 1 : 0);
+  }
+  if (changed & PROTECT_ACTION_OPEN_OUTPUT) {
+    SYSTEM_SetPowerInhibit(INHIBIT_PROTECTION, (actions & PROTECT_ACTION_OPEN_OUTPUT) ? 1 : 0);
+  }
+
+  // The low-voltage warning shares the LED: held here every frame while an
+  // alarm rule is tripped, handed back to the bank alarm levels on release
+  if (actions & PROTECT_ACTION_ALARM) {
+    SYSTEM_SetLED(LED_WARNING, 1);
+  } else if (changed & PROTECT_ACTION_ALARM) {
+    uint8_t warning = 0;
+    for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+      if (BATTERY_GetAlarm(bank) >= BATTERY_ALARM_WARNING) {
+        warning = 1;
+      }
+    }
+    SYSTEM_SetLED(LED_WARNING, warning);
+  }
+
+  status.actions = actions;
+}
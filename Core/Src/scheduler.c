@@ -0,0 +1,397 @@
+/**
+  ******************************************************************************
+  * @file    scheduler.c
+  * @brief   Time-triggered scheduler module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "scheduler.h"
+#include "timebase.h"
+#include "tim.h"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+  SchedTask_t run;
+  uint32_t nextRelease;   // Tick of the next release
+  uint32_t releaseCycles; // DWT time of the tick interrupt of the pending release
+  uint8_t ready;          // Released, not run yet
+} TaskState_t;
+
+/* Private constants ---------------------------------------------------------*/
+#define STACK_PAINT_MARGIN 64 // Bytes below the stack pointer left unpainted at init
+#define STACK_GUARD_WORDS  8  // Words below the stack mark checked for a run deeper than any before
+
+/* Linker script symbols (STM32F103C8TX_FLASH.ld) */
+extern uint32_t _end;
+extern uint32_t _estack;
+extern uint32_t _Min_Heap_Size;
+
+/* Private variables ---------------------------------------------------------*/
+static TaskState_t tasks[SCHED_MAX_TASKS];
+static SchedStatus_t status;
+static volatile uint32_t tickCount = 0;  // Written by the TIM2 interrupt only
+static volatile uint32_t tickCycles = 0; // DWT time of the last tick interrupt
+static uint32_t handledTicks[2] = {0};   // Ticks already released, per SchedLevelEnum
+static uint8_t preemptTasks = 0;         // Tasks registered on SCHED_LEVEL_PREEMPT
+static uint32_t cyclesPerMs = 1;
+static uint32_t* stackFloor;             // Lowest stack word, above the heap reserve
+static uint32_t* stackMark;              // Lowest stack word used so far, all below it painted
+static uint32_t* backgroundLow;          // Lowest word used under the running background task
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t ReleaseTasks(uint8_t level);
+static uint8_t RunTasks(uint8_t level);
+static uint32_t* ReclaimStack(uint32_t* entry);
+
+/**
+  * @brief  Initialize the scheduler with no tasks and paint the free stack
+  * @retval None
+  */
+void SCHED_Init(void)
+{
+  uint8_t* raw = (uint8_t*)&status;
+  for (uint16_t i = 0; i < sizeof(status); i++) {
+    raw[i] = 0;
+  }
+
+  tickCount = 0;
+  handledTicks[SCHED_LEVEL_BACKGROUND] = 0;
+  handledTicks[SCHED_LEVEL_PREEMPT] = 0;
+  preemptTasks = 0;
+  cyclesPerMs = SystemCoreClock / 1000;
+  status.taskBytes = sizeof(TaskState_t) + sizeof(SchedTaskStats_t);
+
+  // Everything between the heap reserve and the live stack is free to paint
+  stackFloor = (uint32_t*)(((uint32_t)&_end + (uint32_t)&_Min_Heap_Size + 3) & ~3UL);
+  stackMark = (uint32_t*)(__get_MSP() - STACK_PAINT_MARGIN);
+  backgroundLow = stackMark;
+  for (uint32_t* word = stackFloor; word < stackMark; word++) {
+    *word = SCHED_STACK_PAINT;
+  }
+}
+
+/**
+  * @brief  Register a periodic task
+  * @note   Call before SCHED_Start; registration order is priority order within a level
+  * @param  task: Function run to completion on every release
+  * @param  level: SCHED_LEVEL_BACKGROUND or SCHED_LEVEL_PREEMPT
+  * @param  periodMs: Release period in ms (at least 1)
+  * @param  phaseMs: Offset of the first release in ms, spreads tasks of equal period
+  * @param  budgetUs: Execution time above which a run counts as an overrun
+  * @retval Task index, SCHED_MAX_TASKS if the table is full
+  */
+uint8_t SCHED_AddTask(SchedTask_t task, uint8_t level, uint16_t periodMs, uint16_t phaseMs,
+                      uint16_t budgetUs)
+{
+  uint8_t index = status.taskCount;
+
+  if (index >= SCHED_MAX_TASKS || task == NULL || periodMs == 0 || level > SCHED_LEVEL_PREEMPT) {
+    return SCHED_MAX_TASKS;
+  }
+
+  tasks[index].run = task;
+  tasks[index].nextRelease = phaseMs;
+  tasks[index].releaseCycles = 0;
+  tasks[index].ready = 0;
+  status.tasks[index].periodMs = periodMs;
+  status.tasks[index].phaseMs = phaseMs;
+  status.tasks[index].budgetUs = budgetUs;
+  status.tasks[index].level = level;
+  status.taskCount++;
+
+  if (level == SCHED_LEVEL_PREEMPT) {
+    preemptTasks++;
+  }
+
+  return index;
+}
+
+/**
+  * @brief  Start the 1 ms scheduler tick (TIM2 update interrupt)
+  * @retval None
+  */
+void SCHED_Start(void)
+{
+  // The borrowed vector has no peripheral behind it, it is only ever pended
+  HAL_NVIC_SetPriority(SCHED_LANE_IRQn, SCHED_LANE_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(SCHED_LANE_IRQn);
+
+  if (HAL_TIM_Base_Start_IT(&htim2) != HAL_OK) {
+    Error_Handler();
+  }
+}
+
+/**
+  * @brief  Count one scheduler tick and pend the preempting level
+  * @note   Called from the TIM2 update interrupt every 1 ms
+  * @retval None
+  */
+void SCHED_TickFromISR(void)
+{
+  tickCycles = DWT->CYCCNT;
+  tickCount++;
+  status.ticks = tickCount;
+
+  if (preemptTasks) {
+    NVIC_SetPendingIRQ(SCHED_LANE_IRQn);
+  }
+}
+
+/**
+  * @brief  Release and run the preempting tasks
+  * @note   Called from the SCHED_LANE_IRQn handler
+  * @retval None
+  */
+void SCHED_LaneFromISR(void)
+{
+  ReleaseTasks(SCHED_LEVEL_PREEMPT);
+  RunTasks(SCHED_LEVEL_PREEMPT);
+}
+
+/**
+  * @brief  Release and run the background tasks due since the last call
+  * @note   Main loop only
+  * @retval Number of tasks run
+  */
+uint8_t SCHED_Run(void)
+{
+  uint32_t catchUp = ReleaseTasks(SCHED_LEVEL_BACKGROUND);
+
+  if (catchUp > status.maxCatchUp) {
+    status.maxCatchUp = catchUp;
+  }
+
+  return RunTasks(SCHED_LEVEL_BACKGROUND);
+}
+
+/**
+  * @brief  Check whether the background level has nothing left to run
+  * @note   Call with interrupts disabled so no tick slips in before sleeping
+  * @retval 1 if no tick is unhandled and no task is ready
+  */
+uint8_t SCHED_IsIdle(void)
+{
+  if (tickCount != handledTicks[SCHED_LEVEL_BACKGROUND]) {
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < status.taskCount; i++) {
+    if (status.tasks[i].level == SCHED_LEVEL_BACKGROUND && tasks[i].ready) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Pause the scheduler tick
+  * @note   Used around Stop mode; ticks are not counted while paused
+  * @retval None
+  */
+void SCHED_Suspend(void)
+{
+  // The counter holds its position, so the next tick keeps its phase
+  __HAL_TIM_DISABLE(&htim2);
+}
+
+/**
+  * @brief  Resume the scheduler tick paused by SCHED_Suspend
+  * @retval None
+  */
+void SCHED_Resume(void)
+{
+  __HAL_TIM_ENABLE(&htim2);
+}
+
+/**
+  * @brief  Keep the preempting level out of a section shared with it
+  * @note   Nests; interrupts above SCHED_LANE_PRIORITY still run
+  * @retval Key for SCHED_Unlock
+  */
+uint32_t SCHED_Lock(void)
+{
+  uint32_t key = __get_BASEPRI();
+
+  __set_BASEPRI_MAX(SCHED_LANE_PRIORITY << (8U - __NVIC_PRIO_BITS));
+  return key;
+}
+
+/**
+  * @brief  Leave a section entered with SCHED_Lock
+  * @param  key: Value returned by the matching SCHED_Lock
+  * @retval None
+  */
+void SCHED_Unlock(uint32_t key)
+{
+  __set_BASEPRI(key);
+}
+
+/**
+  * @brief  Get per-task timing statistics and the stack peak
+  * @note   Scans the painted stack for the peak
+  * @retval Pointer to the status
+  */
+const SchedStatus_t* SCHED_GetStatus(void)
+{
+  // The deepest the stack has reached: the mark of the task runs, or an
+  // interrupt outside them that left a lower word unpainted
+  uint32_t* word = stackFloor;
+  while (word < stackMark && *word == SCHED_STACK_PAINT) {
+    word++;
+  }
+  status.stackPeak = (uint16_t)((uint32_t)&_estack - (uint32_t)word);
+
+  return &status;
+}
+
+/**
+  * @brief  Mark the tasks of a level whose release time has come ready
+  * @param  level: SchedLevelEnum
+  * @retval Ticks caught up
+  */
+static uint32_t ReleaseTasks(uint8_t level)
+{
+  uint32_t now;
+  uint32_t nowCycles;
+
+  // Tick count and its time are written together by the TIM2 interrupt
+  do {
+    now = tickCount;
+    nowCycles = tickCycles;
+  } while (now != tickCount);
+
+  uint32_t catchUp = now - handledTicks[level];
+
+  // Release tick by tick so no release is lost after a long task
+  while (handledTicks[level] != now) {
+    uint32_t tick = ++handledTicks[level];
+
+    for (uint8_t i = 0; i < status.taskCount; i++) {
+      TaskState_t* task = &tasks[i];
+
+      if (status.tasks[i].level != level || (int32_t)(tick - task->nextRelease) < 0) {
+        continue;
+      }
+      task->nextRelease += status.tasks[i].periodMs;
+
+      if (task->ready) {
+        status.tasks[i].missed++;
+      } else {
+        task->ready = 1;
+        task->releaseCycles = nowCycles - (now - tick) * cyclesPerMs;
+      }
+    }
+  }
+
+  return catchUp;
+}
+
+/**
+  * @brief  Run the ready tasks of a level in registration order
+  * @param  level: SchedLevelEnum
+  * @retval Number of tasks run
+  */
+static uint8_t RunTasks(uint8_t level)
+{
+  uint8_t ran = 0;
+
+  for (uint8_t i = 0; i < status.taskCount; i++) {
+    TaskState_t* task = &tasks[i];
+    SchedTaskStats_t* stats = &status.tasks[i];
+
+    if (stats->level != level || !task->ready) {
+      continue;
+    }
+    task->ready = 0;
+
+    uint32_t* entry = (uint32_t*)__get_MSP();
+    if (level == SCHED_LEVEL_BACKGROUND) {
+      backgroundLow = entry;
+    }
+
+    uint32_t startCycles = DWT->CYCCNT;
+    uint32_t latencyUs = (uint32_t)TIMEBASE_ToMicros((Timestamp_t)(startCycles - task->releaseCycles));
+    if (latencyUs > stats->maxLatencyUs) {
+      stats->maxLatencyUs = latencyUs;
+    }
+
+    task->run();
+    uint32_t us = (uint32_t)TIMEBASE_ToMicros((Timestamp_t)(DWT->CYCCNT - startCycles));
+
+    stats->runs++;
+    stats->lastUs = us;
+    if (us > stats->maxUs) {
+      stats->maxUs = us;
+    }
+    if (us > stats->budgetUs) {
+      stats->overruns++;
+    }
+
+    // A preempting run repaints below the background task it interrupted,
+    // which keeps the lowest word of it for the background task
+    uint32_t* low = ReclaimStack(entry);
+    if (level == SCHED_LEVEL_PREEMPT) {
+      if (low < backgroundLow) {
+        backgroundLow = low;
+      }
+    } else if (backgroundLow < low) {
+      low = backgroundLow;
+    }
+    uint16_t stackBytes = (uint16_t)((uint32_t)entry - (uint32_t)low);
+    if (stackBytes > stats->maxStack) {
+      stats->maxStack = stackBytes;
+    }
+    ran++;
+  }
+
+  return ran;
+}
+
+/**
+  * @brief  Find the stack used by the run that just returned and repaint it
+  * @note   Interrupts taken during the run count as part of it; the words
+  *         are repainted so that the next run is measured on its own
+  * @param  entry: Stack pointer when the run started
+  * @retval Lowest stack word used by the run
+  */
+static uint32_t* ReclaimStack(uint32_t* entry)
+{
+  uint32_t* start = (stackMark - stackFloor > STACK_GUARD_WORDS) ?
+                    stackMark - STACK_GUARD_WORDS : stackFloor;
+  uint32_t* word = start;
+
+  // Everything below the mark is painted, the scan starts just under it
+  while (word < entry && *word == SCHED_STACK_PAINT) {
+    word++;
+  }
+
+  // A used guard word: the run went below the mark, scan from the floor
+  if (word < stackMark && start != stackFloor) {
+    word = stackFloor;
+    while (word < entry && *word == SCHED_STACK_PAINT) {
+      word++;
+    }
+  }
+  uint32_t* low = word;
+
+  // Up to this frame only, everything above it is still in use
+  uint32_t* top = (uint32_t*)__get_MSP();
+  for (word = low; word < top; word++) {
+    *word = SCHED_STACK_PAINT;
+  }
+
+  uint32_t key = SCHED_Lock();
+  if (low < stackMark) {
+    stackMark = low;
+  }
+  SCHED_Unlock(key);
+
+  return low;
+}
@@ -0,0 +1,221 @@
+/**
+  ******************************************************************************
+  * @file    standby_monitor.c
+  * @brief   Standby self-discharge monitor module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "standby_monitor.h"
+#include "system_control.h"
+#include "lifetime_stats.h"
+#include "nvm_storage.h"
+#include "event_log.h"
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+  float referenceMv;  // First reading of the window, subtracted for precision
+  float sumT;         // Sums for the least-squares line v = a + b * t
+  float sumV;         // (t in hours since window start, v in mV above reference)
+  float sumTT;
+  float sumTV;
+} DrainFit_t;
+
+/* Private variables ---------------------------------------------------------*/
+static StandbyHistory_t history;
+static DrainFit_t fits[BATTERY_BANK_COUNT];
+static uint8_t fitSamples = 0;
+static uint32_t windowStart = 0;   // Tick of the first reading in the fit window
+static uint8_t resting = 0;
+static uint32_t restSince = 0;
+static uint32_t lastUpdateTime = 0;
+static uint32_t readingSum[BATTERY_BANK_COUNT]; // mV accumulated for the current reading
+static uint16_t readingCount = 0;
+static uint32_t readingStart = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static void ResetFit(void);
+static void AddReading(uint32_t readingTime);
+static void StoreFit(void);
+
+/**
+  * @brief  Initialize the standby monitor and restore its history from flash
+  * @note   NVM_Init must have been called
+  * @retval None
+  */
+void STANDBY_Init(void)
+{
+  if (!NVM_Read(NVM_TAG_STANDBY, &history, sizeof(history)) ||
+      history.head >= STANDBY_HISTORY_SIZE || history.count > STANDBY_HISTORY_SIZE) {
+    history.head = 0;
+    history.count = 0;
+    history.alarm = 0;
+  }
+
+  resting = 0;
+  lastUpdateTime = HAL_GetTick();
+  ResetFit();
+}
+
+/**
+  * @brief  Take rested readings and fit drain rates while in standby
+  * @retval None
+  */
+void STANDBY_Update(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+
+  if (currentTime - lastUpdateTime < STANDBY_UPDATE_INTERVAL) {
+    return;
+  }
+  lastUpdateTime = currentTime;
+
+  // Only a bank with output and charge both off is at rest
+  if (SYSTEM_IsPowerOutputOn() || SYSTEM_GetChargeMode() != CHARGE_OFF) {
+    resting = 0;
+    return;
+  }
+
+  if (!resting) {
+    resting = 1;
+    restSince = currentTime;
+    ResetFit();
+    return;
+  }
+
+  // Let the surface charge settle before taking readings
+  if (currentTime - restSince < STANDBY_REST_TIME) {
+    return;
+  }
+
+  if (readingCount == 0) {
+    readingStart = currentTime;
+  }
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    readingSum[bank] += (uint32_t)(systemState.voltages[bank] * 1000.0f);
+  }
+  readingCount++;
+
+  if (currentTime - readingStart >= STANDBY_SAMPLE_INTERVAL) {
+    // One rested reading, time-stamped at the middle of its interval
+    AddReading(readingStart + (currentTime - readingStart) / 2);
+
+    if (fitSamples >= STANDBY_FIT_SAMPLES) {
+      StoreFit();
+      ResetFit();
+    }
+  }
+}
+
+/**
+  * @brief  Get the drain rate history
+  * @retval Pointer to the history
+  */
+const StandbyHistory_t* STANDBY_GetHistory(void)
+{
+  return &history;
+}
+
+/**
+  * @brief  Start a new fit window
+  * @retval None
+  */
+static void ResetFit(void)
+{
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    DrainFit_t* fit = &fits[bank];
+    fit->referenceMv = 0.0f;
+    fit->sumT = 0.0f;
+    fit->sumV = 0.0f;
+    fit->sumTT = 0.0f;
+    fit->sumTV = 0.0f;
+    readingSum[bank] = 0;
+  }
+  fitSamples = 0;
+  readingCount = 0;
+}
+
+/**
+  * @brief  Add the averaged reading to the fit of every bank
+  * @param  readingTime: Tick the reading represents
+  * @retval None
+  */
+static void AddReading(uint32_t readingTime)
+{
+  if (fitSamples == 0) {
+    windowStart = readingTime;
+  }
+
+  float t = (float)(readingTime - windowStart) / 3600000.0f;
+
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    DrainFit_t* fit = &fits[bank];
+    float mv = (float)readingSum[bank] / (float)readingCount;
+
+    if (fitSamples == 0) {
+      fit->referenceMv = mv;
+    }
+    mv -= fit->referenceMv;
+
+    fit->sumT += t;
+    fit->sumV += mv;
+    fit->sumTT += t * t;
+    fit->sumTV += t * mv;
+    readingSum[bank] = 0;
+  }
+
+  fitSamples++;
+  readingCount = 0;
+}
+
+/**
+  * @brief  Store the fitted drain rates in the history and check the alarm
+  * @retval None
+  */
+static void StoreFit(void)
+{
+  StandbyFit_t* entry = &history.entries[history.head];
+  float n = (float)fitSamples;
+
+  entry->operatingSeconds = LIFETIME_GetOperatingSeconds();
+
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    DrainFit_t* fit = &fits[bank];
+    float denominator = n * fit->sumTT - fit->sumT * fit->sumT;
+    float slope = 0.0f;
+
+    if (denominator > 0.0f) {
+      slope = (n * fit->sumTV - fit->sumT * fit->sumV) / denominator; // mV/h
+    }
+
+    float rate = -slope * 10.0f;
+    if (rate > 32767.0f) rate = 32767.0f;
+    if (rate < -32768.0f) rate = -32768.0f;
+    entry->drainRate[bank] = (int16_t)rate;
+    entry->restVoltage[bank] = (uint16_t)(fit->referenceMv + fit->sumV / n + 0.5f);
+
+    uint8_t bankBit = (uint8_t)(1 << bank);
+    if (entry->drainRate[bank] > STANDBY_DRAIN_ALARM) {
+      if (!(history.alarm & bankBit)) {
+        EVENT_Post(EVENT_DRAIN_ALARM, bank, (uint16_t)entry->drainRate[bank]);
+      }
+      history.alarm |= bankBit;
+    } else {
+      history.alarm &= ~bankBit;
+    }
+  }
+
+  history.head = (history.head + 1) % STANDBY_HISTORY_SIZE;
+  if (history.count < STANDBY_HISTORY_SIZE) {
+    history.count++;
+  }
+
+  // At most one write per fit window
+  NVM_Write(NVM_TAG_STANDBY, &history, sizeof(history));
+}
@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  * @file    state_machine.c
+  * @brief   System state machine module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "state_machine.h"
+#include "system_control.h"
+#include "fault_handling.h"
+#include "event_log.h"
+#include "timebase.h"
+
+/* Private types -------------------------------------------------------------*/
+typedef uint8_t (*StateGuard_t)(void);
+typedef void (*StateAction_t)(void);
+
+typedef struct {
+  uint8_t state;          // State selected when the guard holds
+  StateGuard_t guard;     // Condition for the state
+  uint32_t qualifyTime;   // ms the guard must hold before entering
+} StateRule_t;
+
+typedef struct {
+  StateAction_t onEntry;
+  StateAction_t onExit;
+} StateActions_t;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t IsFaulted(void);
+static uint8_t IsCharging(void);
+static uint8_t IsDischarging(void);
+static uint8_t IsIdle(void);
+static void EnterCharging(void);
+static void ExitCharging(void);
+static const StateRule_t* DeriveState(void);
+
+/* Private constants ---------------------------------------------------------*/
+/* Rules are evaluated in order, the first guard that holds wins */
+static const StateRule_t stateRules[] = {
+  { STATE_ERROR,       IsFaulted,     0 },
+  { STATE_CHARGING,    IsCharging,    STATE_QUALIFY_TIME },
+  { STATE_DISCHARGING, IsDischarging, STATE_QUALIFY_TIME },
+  { STATE_STANDBY,     IsIdle,        STATE_QUALIFY_TIME },
+};
+
+static const StateActions_t stateActions[STATE_COUNT] = {
+  [STATE_STANDBY]     = { NULL,          NULL },
+  [STATE_CHARGING]    = { EnterCharging, ExitCharging },
+  [STATE_DISCHARGING] = { NULL,          NULL },
+  [STATE_ERROR]       = { NULL,          NULL },
+};
+
+/* Private variables ---------------------------------------------------------*/
+static StateStats_t stateStats;
+static uint8_t pendingState = STATE_STANDBY;
+static uint32_t pendingSince = 0;
+
+/**
+  * @brief  Initialize the state machine in STATE_STANDBY
+  * @retval None
+  */
+void STATE_Init(void)
+{
+  uint8_t* raw = (uint8_t*)&stateStats;
+  for (uint16_t i = 0; i < sizeof(stateStats); i++) {
+    raw[i] = 0;
+  }
+
+  stateStats.qualifyTime = STATE_QUALIFY_TIME;
+  systemState.state = STATE_STANDBY;
+  pendingState = STATE_STANDBY;
+  pendingSince = HAL_GetTick();
+  stateStats.enteredAt[STATE_STANDBY] = pendingSince;
+}
+
+/**
+  * @brief  Derive the system state and update systemState.state
+  * @retval None
+  */
+void STATE_Update(void)
+{
+  uint32_t currentTime = HAL_GetTick();
+  const StateRule_t* rule = DeriveState();
+  uint8_t current = systemState.state;
+
+  if (rule->state == current) {
+    pendingState = current;
+    return;
+  }
+
+  // Condition changed: the qualify time runs from here
+  if (rule->state != pendingState) {
+    pendingState = rule->state;
+    pendingSince = currentTime;
+  }
+
+  if (currentTime - pendingSince < rule->qualifyTime) {
+    return;
+  }
+
+  // Beyond the qualify time only the polling and the task delay remain
+  stateStats.lastDelay = currentTime - pendingSince - rule->qualifyTime;
+  if (stateStats.lastDelay > stateStats.maxDelay) {
+    stateStats.maxDelay = stateStats.lastDelay;
+  }
+
+  // Transition: exit action, state change, entry action
+  Timestamp_t start = TIMEBASE_Now();
+  if (stateActions[current].onExit != NULL) {
+    stateActions[current].onExit();
+  }
+
+  systemState.state = rule->state;
+  stateStats.counts[current][rule->state]++;
+  stateStats.enteredAt[rule->state] = currentTime;
+
+  if (stateActions[rule->state].onEntry != NULL) {
+    stateActions[rule->state].onEntry();
+  }
+
+  stateStats.lastActionUs = (uint32_t)TIMEBASE_ToMicros(TIMEBASE_Now() - start);
+  if (stateStats.lastActionUs > stateStats.maxActionUs) {
+    stateStats.maxActionUs = stateStats.lastActionUs;
+  }
+
+  EVENT_Post(EVENT_STATE_CHANGE, current, rule->state);
+}
+
+/**
+  * @brief  Get transition statistics
+  * @retval Pointer to the statistics
+  */
+const StateStats_t* STATE_GetStats(void)
+{
+  return &stateStats;
+}
+
+/**
+  * @brief  Find the first rule whose guard holds
+  * @retval Matching rule (the last rule always matches)
+  */
+static const StateRule_t* DeriveState(void)
+{
+  const uint8_t ruleCount = sizeof(stateRules) / sizeof(stateRules[0]);
+
+  for (uint8_t i = 0; i < ruleCount; i++) {
+    if (stateRules[i].guard()) {
+      return &stateRules[i];
+    }
+  }
+  return &stateRules[ruleCount - 1];
+}
+
+/**
+  * @brief  Guard: any fault is active
+  * @retval 1 if the guard holds
+  */
+static uint8_t IsFaulted(void)
+{
+  return FAULT_GetState() != FAULT_NONE;
+}
+
+/**
+  * @brief  Guard: a charge mode is enabled, not inhibited, and a charger is present
+  * @retval 1 if the guard holds
+  */
+static uint8_t IsCharging(void)
+{
+  return SYSTEM_GetChargeMode() != CHARGE_OFF && !SYSTEM_GetChargeInhibit() &&
+         systemState.voltages[CHARGE] > STATE_CHARGER_PRESENT_VOLTAGE;
+}
+
+/**
+  * @brief  Guard: power output is driven on
+  * @retval 1 if the guard holds
+  */
+static uint8_t IsDischarging(void)
+{
+  return SYSTEM_IsPowerOutputOn();
+}
+
+/**
+  * @brief  Guard: default state
+  * @retval 1
+  */
+static uint8_t IsIdle(void)
+{
+  return 1;
+}
+
+/**
+  * @brief  Entry action of STATE_CHARGING
+  * @retval None
+  */
+static void EnterCharging(void)
+{
+  SYSTEM_SetLED(LED_CHARGING, 1);
+}
+
+/**
+  * @brief  Exit action of STATE_CHARGING
+  * @retval None
+  */
+static void ExitCharging(void)
+{
+  SYSTEM_SetLED(LED_CHARGING, 0);
+}
@@ -22,6 +22,13 @@
 #include "stm32f1xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "fault_handling.h"
+#include "timebase.h"
+#include "watchdog.h"
+#include "supply_monitor.h"
+#include "latch_relay.h"
+#include "scheduler.h"
+#include "power_manager.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -46,7 +53,11 @@
 
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN PFP */
-
+/* The fault line handlers run from RAM up to the cutoff, see fault_handling.h */
+__RAM_FUNC void EXTI1_IRQHandler(void);
+__RAM_FUNC void EXTI9_5_IRQHandler(void);
+/* The power-fail save runs from RAM as well, see supply_monitor.h */
+__RAM_FUNC void PVD_IRQHandler(void);
 /* USER CODE END PFP */
 
 /* Private user code ---------------------------------------------------------*/
@@ -56,6 +67,7 @@
 
 /* External variables --------------------------------------------------------*/
 extern PCD_HandleTypeDef hpcd_USB_FS;
+extern TIM_HandleTypeDef htim2;
 /* USER CODE BEGIN EV */
 
 /* USER CODE END EV */
@@ -78,21 +90,6 @@ void NMI_Handler(void)
   /* USER CODE END NonMaskableInt_IRQn 1 */
 }
 
-/**
-  * @brief This function handles Hard fault interrupt.
-  */
-void HardFault_Handler(void)
-{
-  /* USER CODE BEGIN HardFault_IRQn 0 */
-
-  /* USER CODE END HardFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_HardFault_IRQn 0 */
-    /* USER CODE END W1_HardFault_IRQn 0 */
-  }
-}
-
 /**
   * @brief This function handles Memory management fault.
   */
@@ -187,6 +184,10 @@ void SysTick_Handler(void)
   /* USER CODE END SysTick_IRQn 0 */
   HAL_IncTick();
   /* USER CODE BEGIN SysTick_IRQn 1 */
+  TIMEBASE_TickFromISR();
+  FAULT_TickFromISR();
+  LATCH_TickFromISR();
+  WATCHDOG_TickFromISR();
 
   /* USER CODE END SysTick_IRQn 1 */
 }
@@ -198,6 +199,34 @@ void SysTick_Handler(void)
 /* please refer to the startup file (startup_stm32f1xx.s).                    */
 /******************************************************************************/
 
+/**
+  * @brief This function handles PVD interrupt through EXTI line 16.
+  */
+void PVD_IRQHandler(void)
+{
+  /* USER CODE BEGIN PVD_IRQn 0 */
+  SUPPLY_PowerFailFromISR(DWT->CYCCNT);
+  /* USER CODE END PVD_IRQn 0 */
+  HAL_PWR_PVD_IRQHandler();
+  /* USER CODE BEGIN PVD_IRQn 1 */
+
+  /* USER CODE END PVD_IRQn 1 */
+}
+
+/**
+  * @brief This function handles EXTI line1 interrupt.
+  */
+void EXTI1_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI1_IRQn 0 */
+  FAULT_CutoffFromISR(DWT->CYCCNT);
+  /* USER CODE END EXTI1_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(FLT_BLOCK_200A_Pin);
+  /* USER CODE BEGIN EXTI1_IRQn 1 */
+
+  /* USER CODE END EXTI1_IRQn 1 */
+}
+
 /**
   * @brief This function handles USB low priority or CAN RX0 interrupts.
   */
@@ -212,6 +241,52 @@ void USB_LP_CAN1_RX0_IRQHandler(void)
   /* USER CODE END USB_LP_CAN1_RX0_IRQn 1 */
 }
 
+/**
+  * @brief This function handles EXTI line[9:5] interrupts.
+  */
+void EXTI9_5_IRQHandler(void)
+{
+  /* USER CODE BEGIN EXTI9_5_IRQn 0 */
+  FAULT_CutoffFromISR(DWT->CYCCNT);
+  /* USER CODE END EXTI9_5_IRQn 0 */
+  HAL_GPIO_EXTI_IRQHandler(FLT_FAST_CHARGE_Pin);
+  HAL_GPIO_EXTI_IRQHandler(FLT_CHARGE_Pin);
+  HAL_GPIO_EXTI_IRQHandler(FLT_BLOCK_100A_Pin);
+  /* USER CODE BEGIN EXTI9_5_IRQn 1 */
+
+  /* USER CODE END EXTI9_5_IRQn 1 */
+}
+
+/**
+  * @brief This function handles TIM2 global interrupt.
+  */
+void TIM2_IRQHandler(void)
+{
+  /* USER CODE BEGIN TIM2_IRQn 0 */
+
+  /* USER CODE END TIM2_IRQn 0 */
+  HAL_TIM_IRQHandler(&htim2);
+  /* USER CODE BEGIN TIM2_IRQn 1 */
+
+  /* USER CODE END TIM2_IRQn 1 */
+}
+
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles the preempting scheduler level (SCHED_LANE_IRQn).
+  * @note  CAN is not used, the vector is only pended by SCHED_TickFromISR.
+  */
+void CAN1_SCE_IRQHandler(void)
+{
+  SCHED_LaneFromISR();
+}
 
+/**
+  * @brief This function handles the RTC alarm through EXTI line 17.
+  * @note  Only ends a Stop mode period, see power_manager.
+  */
+void RTC_Alarm_IRQHandler(void)
+{
+  POWER_AlarmFromISR();
+}
 /* USER CODE END 1 */
@@ -0,0 +1,244 @@
+/**
+  ******************************************************************************
+  * @file    supply_monitor.c
+  * @brief   Supply brown-out detection and emergency save module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "supply_monitor.h"
+#include "system_control.h"
+#include "fault_handling.h"
+#include "lifetime_stats.h"
+#include "nvm_storage.h"
+#include "event_log.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define SUPPLY_PAGE_END       (NVM_EMERGENCY_BASE + FLASH_PAGE_SIZE)
+#define SUPPLY_SLOTS          (FLASH_PAGE_SIZE / SUPPLY_RECORD_SIZE)
+#define SUPPLY_RECORD_WORDS   (offsetof(SupplyRecord_t, checksum) / sizeof(uint32_t))
+#define SUPPLY_SAVE_HALFWORDS (offsetof(SupplyRecord_t, saveTimeUs) / sizeof(uint16_t))
+
+/* Private variables ---------------------------------------------------------*/
+static SupplyRecord_t records[2];          // Double buffer, the ISR reads records[ready]
+static volatile uint8_t ready = 0;
+static volatile uint8_t armed = 0;
+static uint32_t nextSlot = SUPPLY_PAGE_END; // Erased slot for the next save
+static const SupplyRecord_t* lastRecord = NULL;
+static uint8_t lastFaults = 0;
+static uint8_t lastFault = 0;               // Carried into every record, the published one is never written
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t RecordChecksum(const SupplyRecord_t* record);
+static uint8_t IsErased(uint32_t address);
+__RAM_FUNC static void ProgramFromISR(uint32_t address, const uint16_t* data, uint16_t count);
+
+/**
+  * @brief  Journal the last emergency record and prepare the next slot
+  * @note   EVENT_Init must have been called; may erase the page (boot only)
+  * @retval None
+  */
+void SUPPLY_Init(void)
+{
+  uint32_t sequence = 0;
+
+  // Slots are used in order, the next one follows the last programmed slot
+  lastRecord = NULL;
+  nextSlot = NVM_EMERGENCY_BASE;
+  for (uint32_t address = NVM_EMERGENCY_BASE; address < SUPPLY_PAGE_END; address += SUPPLY_RECORD_SIZE) {
+    const SupplyRecord_t* record = (const SupplyRecord_t*)address;
+
+    if (IsErased(address)) {
+      continue;
+    }
+    nextSlot = address + SUPPLY_RECORD_SIZE;
+    if (record->checksum == RecordChecksum(record)) {
+      lastRecord = record;
+      sequence = record->sequence;
+    }
+  }
+
+  if (lastRecord != NULL && lastRecord->reported == 0xFFFF) {
+    EVENT_Post(EVENT_POWER_FAIL, lastRecord->lastFault, lastRecord->saveTimeUs);
+
+    HAL_FLASH_Unlock();
+    HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, (uint32_t)&lastRecord->reported, 0);
+    HAL_FLASH_Lock();
+  }
+
+  // Keep a slot erased ahead; the record is not needed once journaled
+  if (nextSlot >= SUPPLY_PAGE_END) {
+    FLASH_EraseInitTypeDef eraseInit = {0};
+    uint32_t pageError = 0;
+
+    eraseInit.TypeErase = FLASH_TYPEERASE_PAGES;
+    eraseInit.PageAddress = NVM_EMERGENCY_BASE;
+    eraseInit.NbPages = 1;
+
+    HAL_FLASH_Unlock();
+    HAL_FLASHEx_Erase(&eraseInit, &pageError);
+    HAL_FLASH_Lock();
+
+    lastRecord = NULL;
+    nextSlot = NVM_EMERGENCY_BASE;
+  }
+
+  records[0].sequence = sequence + 1;
+  records[1].sequence = sequence + 1;
+  lastFaults = 0;
+  lastFault = 0;
+  SUPPLY_Update();
+
+  armed = IsErased(nextSlot);
+}
+
+/**
+  * @brief  Refresh the record kept ready for the emergency save
+  * @retval None
+  */
+void SUPPLY_Update(void)
+{
+  SupplyRecord_t* record = &records[ready ^ 1];
+  uint8_t faults = FAULT_GetState();
+
+  if (faults & ~lastFaults) {
+    lastFault = faults & ~lastFaults;
+  }
+  lastFaults = faults;
+
+  record->lastFault = lastFault;
+
+  record->operatingSeconds = LIFETIME_GetOperatingSeconds();
+  record->tick = HAL_GetTick();
+  record->faults = faults;
+  record->lockedLines = FAULT_GetLockedLines();
+  record->state = systemState.state;
+  for (uint8_t channel = 0; channel < VOLTAGE_COUNT; channel++) {
+    record->voltages[channel] = (uint16_t)(systemState.voltages[channel] * 1000.0f);
+  }
+  record->checksum = RecordChecksum(record);
+  record->saveTimeUs = 0xFFFF;
+  record->reported = 0xFFFF;
+
+  // Publish in one store, the ISR never sees a half-built record
+  __DMB();
+  ready ^= 1;
+}
+
+/**
+  * @brief  Handle a supply drop: outputs off, save the record, reset
+  * @note   Called first in PVD_IRQHandler, does not return. Runs from RAM
+  *         up to the reset, so the outputs drop at once even during a page
+  *         erase; only the save waits for the erase to finish.
+  * @param  entryCycles: DWT->CYCCNT captured on handler entry
+  * @retval None
+  */
+__RAM_FUNC void SUPPLY_PowerFailFromISR(uint32_t entryCycles)
+{
+  SYSTEM_ForceSafeOutputs();
+
+  if (armed) {
+    const SupplyRecord_t* record = &records[ready];
+    uint16_t saveTimeUs;
+
+    ProgramFromISR(nextSlot, (const uint16_t*)record, SUPPLY_SAVE_HALFWORDS);
+
+    // 32-bit divide in hardware, the 64-bit timebase helpers live in flash
+    uint32_t us = (DWT->CYCCNT - entryCycles) / (SystemCoreClock / 1000000);
+    saveTimeUs = us < 0xFFFF ? (uint16_t)us : 0xFFFE;
+    ProgramFromISR(nextSlot + offsetof(SupplyRecord_t, saveTimeUs), &saveTimeUs, 1);
+    armed = 0;
+  }
+
+  // Restart cleanly if the supply comes back, otherwise brown-out reset
+  while (__HAL_PWR_GET_FLAG(PWR_FLAG_PVDO)) {
+  }
+  NVIC_SystemReset();
+}
+
+/**
+  * @brief  Get the most recent emergency record
+  * @retval Pointer to the record in flash, NULL if there is none
+  */
+const SupplyRecord_t* SUPPLY_GetLastRecord(void)
+{
+  return lastRecord;
+}
+
+/**
+  * @brief  Get the number of free emergency slots
+  * @retval Slots left before the page is erased at boot
+  */
+uint16_t SUPPLY_GetFreeSlots(void)
+{
+  return (uint16_t)((SUPPLY_PAGE_END - nextSlot) / SUPPLY_RECORD_SIZE);
+}
+
+/**
+  * @brief  Compute the checksum of an emergency record
+  * @param  record: Record to check
+  * @retval Inverted sum of the record words before the checksum
+  */
+static uint32_t RecordChecksum(const SupplyRecord_t* record)
+{
+  const uint32_t* raw = (const uint32_t*)record;
+  uint32_t sum = 0;
+
+  for (uint8_t i = 0; i < SUPPLY_RECORD_WORDS; i++) {
+    sum += raw[i];
+  }
+  return ~sum;
+}
+
+/**
+  * @brief  Check that a slot is fully erased
+  * @param  address: Slot address
+  * @retval 1 if every word reads 0xFFFFFFFF
+  */
+static uint8_t IsErased(uint32_t address)
+{
+  if (address >= SUPPLY_PAGE_END) {
+    return 0;
+  }
+  for (uint32_t offset = 0; offset < SUPPLY_RECORD_SIZE; offset += 4) {
+    if (*(volatile uint32_t*)(address + offset) != 0xFFFFFFFF) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+  * @brief  Program half-words at register level
+  * @note   No HAL lock or tick timeout, both may be held by the interrupted
+  *         main loop. The controller state is not restored: the caller resets.
+  * @param  address: Flash address (erased)
+  * @param  data: Half-words to program
+  * @param  count: Number of half-words
+  * @retval None
+  */
+__RAM_FUNC static void ProgramFromISR(uint32_t address, const uint16_t* data, uint16_t count)
+{
+  while (FLASH->SR & FLASH_SR_BSY) {
+  }
+  if (FLASH->CR & FLASH_CR_LOCK) {
+    FLASH->KEYR = FLASH_KEY1;
+    FLASH->KEYR = FLASH_KEY2;
+  }
+  FLASH->SR = FLASH_SR_EOP | FLASH_SR_PGERR | FLASH_SR_WRPRTERR;
+  FLASH->CR = FLASH_CR_PG;
+
+  for (uint16_t i = 0; i < count; i++) {
+    *(volatile uint16_t*)(address + i * 2) = data[i];
+    while (FLASH->SR & FLASH_SR_BSY) {
+    }
+  }
+
+  FLASH->CR = 0;
+}
@@ -13,6 +13,9 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "system_control.h"
+#include "fault_handling.h"
+#include "latch_relay.h"
+#include "scheduler.h"
 #include "gpio.h"
 
 /* Private variables ---------------------------------------------------------*/
@@ -21,6 +24,9 @@ static uint32_t lastStatusTime = 0;
 static uint8_t ledStates[LED_COUNT] = {0};
 static uint8_t currentChargeMode = CHARGE_OFF;
 static uint8_t powerOutputEnabled = 0;
+static uint8_t powerInhibit = 0;
+static uint8_t chargeInhibit = 0;
+static uint16_t commandedOutputs[2] = {0}; // Enable pins commanded on, [0] = GPIOA, [1] = GPIOB
 
 /* Private constants ---------------------------------------------------------*/
 #define STATUS_INTERVAL 2000 // 2 seconds
@@ -29,6 +35,8 @@ static uint8_t powerOutputEnabled = 0;
 static void UpdateLEDs(void);
 static void UpdateChargeMode(void);
 static void UpdatePowerOutput(void);
+static void WriteEnable(GPIO_TypeDef* port, uint16_t pin, uint8_t on);
+static uint16_t InhibitedOutputs(GPIO_TypeDef* port);
 
 /**
   * @brief  Initialize the system control module
@@ -59,10 +67,14 @@ void SYSTEM_Init(void)
   */
 void SYSTEM_Update(void)
 {
+  // The preempting level changes the inhibits, decide and write in one go
+  uint32_t key = SCHED_Lock();
+
   // Update hardware states if there were any changes
   UpdateLEDs();
   UpdateChargeMode();
   UpdatePowerOutput();
+  SCHED_Unlock(key);
 }
 
 /**
@@ -131,6 +143,15 @@ void SYSTEM_SetChargeMode(uint8_t mode)
   }
 }
 
+/**
+  * @brief  Get current charge mode
+  * @retval Charge mode (ChargeModeEnum)
+  */
+uint8_t SYSTEM_GetChargeMode(void)
+{
+  return currentChargeMode;
+}
+
 /**
   * @brief  Set power output state
   * @param  state: 0 for off, 1 for on
@@ -141,6 +162,76 @@ void SYSTEM_SetPowerOutput(uint8_t state)
   powerOutputEnabled = state ? 1 : 0;
 }
 
+/**
+  * @brief  Set or release a power output inhibit
+  * @note   Applied to the output immediately, without waiting for SYSTEM_Update
+  * @param  source: Inhibit source (OutputInhibitEnum)
+  * @param  active: 1 to inhibit the output, 0 to release
+  * @retval None
+  */
+void SYSTEM_SetPowerInhibit(uint8_t source, uint8_t active)
+{
+  uint32_t key = SCHED_Lock();
+
+  if (active) {
+    powerInhibit |= source;
+  } else {
+    powerInhibit &= ~source;
+  }
+
+  UpdatePowerOutput();
+  SCHED_Unlock(key);
+}
+
+/**
+  * @brief  Get active power output inhibits
+  * @retval Inhibit source flags (OutputInhibitEnum)
+  */
+uint8_t SYSTEM_GetPowerInhibit(void)
+{
+  return powerInhibit;
+}
+
+/**
+  * @brief  Set or release a charge inhibit
+  * @note   Both charge enables are held off while any inhibit is active;
+  *         the commanded charge mode is kept and resumes on release
+  * @param  source: Inhibit source (OutputInhibitEnum)
+  * @param  active: 1 to inhibit charging, 0 to release
+  * @retval None
+  */
+void SYSTEM_SetChargeInhibit(uint8_t source, uint8_t active)
+{
+  uint32_t key = SCHED_Lock();
+
+  if (active) {
+    chargeInhibit |= source;
+  } else {
+    chargeInhibit &= ~source;
+  }
+
+  UpdateChargeMode();
+  SCHED_Unlock(key);
+}
+
+/**
+  * @brief  Get active charge inhibits
+  * @retval Inhibit source flags (OutputInhibitEnum)
+  */
+uint8_t SYSTEM_GetChargeInhibit(void)
+{
+  return chargeInhibit;
+}
+
+/**
+  * @brief  Check if the power output is actually driven on
+  * @retval 1 if enabled and not inhibited, 0 otherwise
+  */
+uint8_t SYSTEM_IsPowerOutputOn(void)
+{
+  return (powerOutputEnabled && !powerInhibit) ? 1 : 0;
+}
+
 /**
   * @brief  Set relay mode
   * @param  mode: 0 for off, 1 for set, 2 for reset
@@ -150,22 +241,14 @@ void SYSTEM_SetRelayMode(uint8_t mode)
 {
   switch (mode) {
     case RELAY_OFF:
-      HAL_GPIO_WritePin(LATCH_IN1_GPIO_Port, LATCH_IN1_Pin, GPIO_PIN_RESET);
-      HAL_GPIO_WritePin(LATCH_IN2_GPIO_Port, LATCH_IN2_Pin, GPIO_PIN_RESET);
+      // Both coils off now, pending pulses dropped
+      LATCH_Cancel();
       break;
 
     case RELAY_SET:
-      HAL_GPIO_WritePin(LATCH_IN2_GPIO_Port, LATCH_IN2_Pin, GPIO_PIN_RESET);
-      HAL_GPIO_WritePin(LATCH_IN1_GPIO_Port, LATCH_IN1_Pin, GPIO_PIN_SET);
-      HAL_Delay(100); // Pulse for 100ms
-      HAL_GPIO_WritePin(LATCH_IN1_GPIO_Port, LATCH_IN1_Pin, GPIO_PIN_RESET);
-      break;
-
     case RELAY_RESET:
-      HAL_GPIO_WritePin(LATCH_IN1_GPIO_Port, LATCH_IN1_Pin, GPIO_PIN_RESET);
-      HAL_GPIO_WritePin(LATCH_IN2_GPIO_Port, LATCH_IN2_Pin, GPIO_PIN_SET);
-      HAL_Delay(100); // Pulse for 100ms
-      HAL_GPIO_WritePin(LATCH_IN2_GPIO_Port, LATCH_IN2_Pin, GPIO_PIN_RESET);
+      // Queued, the pulse ends when LATCH_FB1/FB2 confirm the position
+      LATCH_Request(mode);
       break;
   }
 }
@@ -207,23 +290,24 @@ static void UpdateLEDs(void)
   */
 static void UpdateChargeMode(void)
 {
-  switch (currentChargeMode) {
+  // An inhibit holds both enables off without forgetting the mode
+  switch (chargeInhibit ? CHARGE_OFF : currentChargeMode) {
     case CHARGE_OFF:
       // Disable both charge modes
-      HAL_GPIO_WritePin(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin, GPIO_PIN_RESET);
-      HAL_GPIO_WritePin(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin, GPIO_PIN_RESET);
+      WriteEnable(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin, 0);
+      WriteEnable(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin, 0);
       break;
 
     case CHARGE_NORMAL:
       // Enable normal charge, disable fast charge
-      HAL_GPIO_WritePin(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin, GPIO_PIN_SET);
-      HAL_GPIO_WritePin(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin, GPIO_PIN_RESET);
+      WriteEnable(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin, 1);
+      WriteEnable(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin, 0);
       break;
 
     case CHARGE_FAST:
       // Enable fast charge, disable normal charge
-      HAL_GPIO_WritePin(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin, GPIO_PIN_RESET);
-      HAL_GPIO_WritePin(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin, GPIO_PIN_SET);
+      WriteEnable(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin, 0);
+      WriteEnable(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin, 1);
       break;
   }
 }
@@ -235,45 +319,118 @@ static void UpdateChargeMode(void)
 static void UpdatePowerOutput(void)
 {
   // Enable/disable power output by controlling the blocking MOSFETs
-  if (powerOutputEnabled) {
+  if (powerOutputEnabled && !powerInhibit) {
     // Enable power output
-    HAL_GPIO_WritePin(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin, GPIO_PIN_SET);
-    HAL_GPIO_WritePin(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin, GPIO_PIN_SET);
+    WriteEnable(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin, 1);
+    WriteEnable(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin, 1);
   } else {
     // Disable power output
-    HAL_GPIO_WritePin(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin, GPIO_PIN_RESET);
-    HAL_GPIO_WritePin(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin, GPIO_PIN_RESET);
+    WriteEnable(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin, 0);
+    WriteEnable(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin, 0);
   }
 }
 
 /**
   * @brief  Set enable signal state
+  * @note   An active inhibit clamps the request to off: the block enables
+  *         follow the power inhibits, the charge enables the charge inhibits
   * @param  signalIndex: 0=EN_FAST_CHARGE, 1=EN_CHARGE, 2=EN_BLOCK_100A, 3=EN_BLOCK_200A
   * @param  state: 0 for off, 1 for on
   * @retval None
   */
 void SYSTEM_SetEnableSignal(uint8_t signalIndex, uint8_t state)
 {
-  GPIO_PinState pinState = state ? GPIO_PIN_SET : GPIO_PIN_RESET;
-
   switch (signalIndex) {
     case 0: // EN_FAST_CHARGE
-      HAL_GPIO_WritePin(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin, pinState);
+      WriteEnable(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin, state);
       break;
 
     case 1: // EN_CHARGE
-      HAL_GPIO_WritePin(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin, pinState);
+      WriteEnable(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin, state);
       break;
 
     case 2: // EN_BLOCK_100A
-      HAL_GPIO_WritePin(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin, pinState);
+      WriteEnable(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin, state);
       break;
 
     case 3: // EN_BLOCK_200A
-      HAL_GPIO_WritePin(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin, pinState);
+      WriteEnable(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin, state);
       break;
 
     default:
       break;
   }
 }
+
+/**
+  * @brief  Get the enable pins last commanded on
+  * @note   Fault cutoffs are not applied, see FAULT_GetBlockedOutputs
+  * @param  port: GPIOA or GPIOB
+  * @retval Pin mask of the port
+  */
+uint16_t SYSTEM_GetCommandedOutputs(GPIO_TypeDef* port)
+{
+  return commandedOutputs[port == GPIOB];
+}
+
+/**
+  * @brief  Drive every enable and relay coil output off
+  * @note   Register writes only, safe from fault handlers and any ISR
+  * @retval None
+  */
+__RAM_FUNC void SYSTEM_ForceSafeOutputs(void)
+{
+  GPIOA->BSRR = (uint32_t)(EN_FAST_CHARGE_Pin | EN_CHARGE_Pin | EN_BLOCK_100A_Pin) << 16;
+  GPIOB->BSRR = (uint32_t)(EN_BLOCK_200A_Pin | LATCH_IN1_Pin | LATCH_IN2_Pin) << 16;
+}
+
+/**
+  * @brief  Drive an enable output unless an inhibit or a fault holds it off
+  * @note   Check and write are atomic against the fault cutoff ISR, so an
+  *         enable cut by the ISR can not be re-asserted by a stale decision.
+  *         An inhibited enable is commanded off, a fault only holds it off.
+  * @param  port: GPIO port of the enable
+  * @param  pin: Enable pin
+  * @param  on: 1 to assert, 0 to de-assert
+  * @retval None
+  */
+static void WriteEnable(GPIO_TypeDef* port, uint16_t pin, uint8_t on)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if (InhibitedOutputs(port) & pin) {
+    on = 0;
+  }
+  if (on) {
+    commandedOutputs[port == GPIOB] |= pin;
+  } else {
+    commandedOutputs[port == GPIOB] &= ~pin;
+  }
+  if (on && !(FAULT_GetBlockedOutputs(port) & pin)) {
+    HAL_GPIO_WritePin(port, pin, GPIO_PIN_SET);
+  } else {
+    HAL_GPIO_WritePin(port, pin, GPIO_PIN_RESET);
+  }
+  __set_PRIMASK(primask);
+}
+
+/**
+  * @brief  Get the enable pins held off by the active inhibits
+  * @param  port: GPIOA or GPIOB
+  * @retval Pin mask of the port
+  */
+static uint16_t InhibitedOutputs(GPIO_TypeDef* port)
+{
+  uint16_t pins = 0;
+
+  if (powerInhibit) {
+    pins |= (port == EN_BLOCK_100A_GPIO_Port) ? EN_BLOCK_100A_Pin : 0;
+    pins |= (port == EN_BLOCK_200A_GPIO_Port) ? EN_BLOCK_200A_Pin : 0;
+  }
+  if (chargeInhibit) {
+    pins |= (port == EN_CHARGE_GPIO_Port) ? EN_CHARGE_Pin : 0;
+    pins |= (port == EN_FAST_CHARGE_GPIO_Port) ? EN_FAST_CHARGE_Pin : 0;
+  }
+  return pins;
+}
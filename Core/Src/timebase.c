@@ -0,0 +1,113 @@
+/**
+  ******************************************************************************
+  * @file    timebase.c
+  * @brief   High resolution timebase module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "timebase.h"
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t wrapCount = 0;   // High word of the timestamp
+static uint32_t lastCycles = 0;  // Low word seen by the last read
+static uint32_t cyclesPerUs = 1;
+
+/**
+  * @brief  Start the DWT cycle counter
+  * @note   Call before any module that takes timestamps
+  * @retval None
+  */
+void TIMEBASE_Init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+  wrapCount = 0;
+  lastCycles = 0;
+  cyclesPerUs = SystemCoreClock / 1000000;
+}
+
+/**
+  * @brief  Keep track of cycle counter wraps
+  * @note   Called from the SysTick handler every 1 ms
+  * @retval None
+  */
+void TIMEBASE_TickFromISR(void)
+{
+  TIMEBASE_Now();
+}
+
+/**
+  * @brief  Get the current time
+  * @note   Safe from any context
+  * @retval Cycles since TIMEBASE_Init
+  */
+Timestamp_t TIMEBASE_Now(void)
+{
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  uint32_t cycles = TIMEBASE_ReadCycles();
+  if (cycles < lastCycles) {
+    wrapCount++;
+  }
+  lastCycles = cycles;
+  Timestamp_t now = ((Timestamp_t)wrapCount << 32) | cycles;
+  __set_PRIMASK(primask);
+
+  return now;
+}
+
+/**
+  * @brief  Read the cycle counter that supplies the low word
+  * @note   Weak so that a host test can supply its own counter
+  * @retval DWT->CYCCNT
+  */
+__weak uint32_t TIMEBASE_ReadCycles(void)
+{
+  return DWT->CYCCNT;
+}
+
+/**
+  * @brief  Extend a raw DWT->CYCCNT capture to a full timestamp
+  * @param  cycles: Capture taken less than one wrap period ago
+  * @retval Timestamp of the capture
+  */
+Timestamp_t TIMEBASE_FromCycles(uint32_t cycles)
+{
+  Timestamp_t now = TIMEBASE_Now();
+
+  // Unsigned difference of the low words is the age of the capture
+  return now - (uint32_t)((uint32_t)now - cycles);
+}
+
+/**
+  * @brief  Add cycles the counter missed while the core clock was stopped
+  * @note   Call with interrupts disabled
+  * @param  cycles: Cycles to add, less than one wrap period
+  * @retval None
+  */
+void TIMEBASE_Advance(uint32_t cycles)
+{
+  // Account for a wrap before the jump, the one after it is seen by the next read
+  TIMEBASE_Now();
+  DWT->CYCCNT += cycles;
+}
+
+/**
+  * @brief  Convert a timestamp to microseconds
+  * @param  timestamp: Time in cycles
+  * @retval Microseconds since TIMEBASE_Init
+  */
+uint64_t TIMEBASE_ToMicros(Timestamp_t timestamp)
+{
+  return timestamp / cyclesPerUs;
+}
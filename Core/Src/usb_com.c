@@ -20,7 +20,7 @@
 extern USBD_HandleTypeDef hUsbDeviceFS;
 
 /* Private variables ---------------------------------------------------------*/
-static char txBuffer[128];
+static char txBuffer[448];
 
 /* System state string representations */
 /*
@@ -40,15 +40,19 @@ void USB_SendStatus(SystemState_t* state)
 {
   int length = 0;
 
-  // Format status string: BAT:xx,STATE:x,FAULT:xx,V1:xxxx,V2:xxxx,V3:xxxx,V4:xxxx
-  length = sprintf(txBuffer, "BAT:%d,STATE:%d,FAULT:%d,V1:%d,V2:%d,V3:%d,V4:%d\r\n",
+  uint64_t sampleUs = TIMEBASE_ToMicros(ADC_GetFrameTime());
+
+  // Format status string: BAT:xx,STATE:x,FAULT:xx,V1:xxxx,V2:xxxx,V3:xxxx,V4:xxxx,T:s.us
+  length = sprintf(txBuffer, "BAT:%d,STATE:%d,FAULT:%d,V1:%d,V2:%d,V3:%d,V4:%d,T:%lu.%06lu\r\n",
                   state->batteryLevel,
                   state->state,
                   state->fault,
                   (int)(state->voltages[LOAD] * 1000),     // Convert to millivolts
                   (int)(state->voltages[CHARGE] * 1000),   // Convert to millivolts
                   (int)(state->voltages[BANK_A] * 1000),   // Convert to millivolts
-                  (int)(state->voltages[BANK_B] * 1000));  // Convert to millivolts
+                  (int)(state->voltages[BANK_B] * 1000),   // Convert to millivolts
+                  (unsigned long)(sampleUs / 1000000),     // Sample time of the voltages
+                  (unsigned long)(sampleUs % 1000000));
 
   // Send via USB
   CDC_Transmit_FS((uint8_t*)txBuffer, length);
@@ -70,19 +74,598 @@ void USB_SendError(const char* errorMsg)
   CDC_Transmit_FS((uint8_t*)txBuffer, length);
 }
 
+/**
+  * @brief  Send lifetime statistics over USB
+  * @param  stats: Pointer to lifetime statistics
+  * @retval None
+  */
+void USB_SendLifetimeStats(const LifetimeStats_t* stats)
+{
+  int length = 0;
+
+  // Format: LIFE:A=efc,dAh,cAh,dWh,cWh,deep;B=...;T=standby,charging,discharging,error
+  // EFC is in hundredths of a cycle, state times in seconds
+  for (uint8_t bank = 0; bank < BATTERY_BANK_COUNT; bank++) {
+    const LifetimeBank_t* b = &stats->banks[bank];
+    length += sprintf(txBuffer + length, "%s%c=%d,%d,%d,%d,%d,%d",
+                      bank == 0 ? "LIFE:" : ";",
+                      'A' + bank,
+                      (int)(LIFETIME_GetEquivalentCycles(bank) * 100),
+                      (int)b->dischargeAh,
+                      (int)b->chargeAh,
+                      (int)b->dischargeWh,
+                      (int)b->chargeWh,
+                      (int)b->deepDischarges);
+  }
+  length += sprintf(txBuffer + length, ";T=%lu,%lu,%lu,%lu\r\n",
+                    (unsigned long)stats->stateSeconds[STATE_STANDBY],
+                    (unsigned long)stats->stateSeconds[STATE_CHARGING],
+                    (unsigned long)stats->stateSeconds[STATE_DISCHARGING],
+                    (unsigned long)stats->stateSeconds[STATE_ERROR]);
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send state machine statistics over USB
+  * @param  stats: Pointer to state machine statistics
+  * @retval None
+  */
+void USB_SendStateStats(const StateStats_t* stats)
+{
+  int length = 0;
+
+  // Format: SM:S=state,AGE=ms,Q=qualifyMs,DLY=lastMs/maxMs,ACT=lastUs/maxUs,N=from0to0/from0to1/.../from3to3
+  length = sprintf(txBuffer, "SM:S=%d,AGE=%lu,Q=%lu,DLY=%lu/%lu,ACT=%lu/%lu,N=",
+                   systemState.state,
+                   (unsigned long)(HAL_GetTick() - stats->enteredAt[systemState.state]),
+                   (unsigned long)stats->qualifyTime,
+                   (unsigned long)stats->lastDelay,
+                   (unsigned long)stats->maxDelay,
+                   (unsigned long)stats->lastActionUs,
+                   (unsigned long)stats->maxActionUs);
+
+  for (uint8_t from = 0; from < STATE_COUNT; from++) {
+    for (uint8_t to = 0; to < STATE_COUNT; to++) {
+      length += sprintf(txBuffer + length, (from | to) ? "/%u" : "%u",
+                        stats->counts[from][to]);
+    }
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send standby drain rate history over USB
+  * @param  history: Pointer to drain rate history
+  * @retval None
+  */
+void USB_SendDrainHistory(const StandbyHistory_t* history)
+{
+  int length = 0;
+
+  // Format: DRAIN:AL=alarm;seconds,rateA,rateB,mvA,mvB;... (oldest first, rates in 0.1 mV/h)
+  length = sprintf(txBuffer, "DRAIN:AL=%d", history->alarm);
+
+  for (uint8_t i = 0; i < history->count; i++) {
+    uint8_t slot = (history->head + STANDBY_HISTORY_SIZE - history->count + i) % STANDBY_HISTORY_SIZE;
+    const StandbyFit_t* entry = &history->entries[slot];
+    length += sprintf(txBuffer + length, ";%lu,%d,%d,%u,%u",
+                      (unsigned long)entry->operatingSeconds,
+                      entry->drainRate[BANK_A],
+                      entry->drainRate[BANK_B],
+                      entry->restVoltage[BANK_A],
+                      entry->restVoltage[BANK_B]);
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send equalization scheduler status over USB
+  * @param  status: Pointer to equalization status
+  * @retval None
+  */
+void USB_SendEqualizeStatus(const EqualizeStatus_t* status)
+{
+  int length = 0;
+  uint32_t since = LIFETIME_GetOperatingSeconds() - status->record.lastRunSeconds;
+
+  // Format: EQ:PH=phase,WAIT=outcome,EL=elapsed/duration,N=cycles,OUT=outcome,SINCE=s,DUE=s
+  length = sprintf(txBuffer, "EQ:PH=%d,WAIT=%d,EL=%lu/%lu,N=%u,OUT=%d,SINCE=%lu,DUE=%lu\r\n",
+                   status->phase,
+                   status->waiting,
+                   (unsigned long)status->elapsed,
+                   (unsigned long)EQUALIZE_DURATION,
+                   status->record.cycles,
+                   status->record.lastOutcome,
+                   (unsigned long)since,
+                   (unsigned long)(since < EQUALIZE_INTERVAL ? EQUALIZE_INTERVAL - since : 0));
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send fault line pulse, cutoff and event queue statistics over USB
+  * @param  stats: Array of FAULT_LINE_COUNT entries indexed by fault bit
+  * @param  queue: Pointer to fault event queue statistics
+  * @retval None
+  */
+void USB_SendFaultLineStats(const FaultLineStats_t* stats, const FaultQueueStats_t* queue)
+{
+  int length = 0;
+
+  // Format: FLT:CLK=hz;faults,glitches,lastUs,maxUs,glitchUs,cutoffs,lastCyc,maxCyc;...;Q=pushed,overflows,resyncs,highWater,maskedCyc
+  length = sprintf(txBuffer, "FLT:CLK=%lu", (unsigned long)SystemCoreClock);
+
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    length += sprintf(txBuffer + length, ";%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+                      (unsigned long)stats[i].faults,
+                      (unsigned long)stats[i].glitches,
+                      (unsigned long)stats[i].lastPulseUs,
+                      (unsigned long)stats[i].maxPulseUs,
+                      (unsigned long)stats[i].lastGlitchUs,
+                      (unsigned long)stats[i].cutoffs,
+                      (unsigned long)stats[i].lastCycles,
+                      (unsigned long)stats[i].maxCycles);
+  }
+  length += sprintf(txBuffer + length, ";Q=%lu,%lu,%lu,%d,%lu\r\n",
+                    (unsigned long)queue->pushed,
+                    (unsigned long)queue->overflows,
+                    (unsigned long)queue->resyncs,
+                    queue->highWater,
+                    (unsigned long)queue->maskedCycles);
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send latched fault status over USB
+  * @param  faults: Current fault flags
+  * @param  locked: Fault flags waiting for a commanded clear
+  * @param  stats: Array of FAULT_LINE_COUNT entries indexed by fault bit
+  * @retval None
+  */
+void USB_SendLatchStatus(uint8_t faults, uint8_t locked, const FaultLineStats_t* stats)
+{
+  int length = 0;
+
+  // Format: LATCH:F=faults,L=locked;retries,lockouts;... (per fault bit)
+  length = sprintf(txBuffer, "LATCH:F=%d,L=%d", faults, locked);
+
+  for (uint8_t i = 0; i < FAULT_LINE_COUNT; i++) {
+    length += sprintf(txBuffer + length, ";%lu,%lu",
+                      (unsigned long)stats[i].retries,
+                      (unsigned long)stats[i].lockouts);
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send one chunk of the flash event journal over USB
+  * @param  chunk: Chunk number, EVENT_JOURNAL_CHUNK records each (0 = oldest)
+  * @retval None
+  */
+void USB_SendJournalChunk(uint16_t chunk)
+{
+  int length = 0;
+  uint16_t count = EVENT_GetJournalCount();
+  JournalRecord_t record;
+
+  // Format: LOG:C=chunk,N=records,DROP=lost;seq,tick,secs,type,source,data,faults,state,mvA,mvB,mvC,mvL;...
+  length = sprintf(txBuffer, "LOG:C=%u,N=%u,DROP=%lu", chunk, count,
+                   (unsigned long)EVENT_GetJournalDropped());
+
+  for (uint16_t i = 0; i < EVENT_JOURNAL_CHUNK; i++) {
+    uint32_t index = (uint32_t)chunk * EVENT_JOURNAL_CHUNK + i;
+    if (index >= count || !EVENT_GetJournal((uint16_t)index, &record)) {
+      break;
+    }
+    length += sprintf(txBuffer + length, ";%lu,%lu,%lu,%d,%d,%u,%d,%d,%u,%u,%u,%u",
+                      (unsigned long)record.sequence,
+                      (unsigned long)record.timestamp,
+                      (unsigned long)record.operatingSeconds,
+                      record.type,
+                      record.source,
+                      record.data,
+                      record.faults,
+                      record.state,
+                      record.voltages[BANK_A],
+                      record.voltages[BANK_B],
+                      record.voltages[CHARGE],
+                      record.voltages[LOAD]);
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send the watchdog reset report and task liveness over USB
+  * @param  status: Pointer to the watchdog status
+  * @retval None
+  */
+void USB_SendWatchdogStatus(const WatchdogStatus_t* status)
+{
+  int length = 0;
+  uint32_t currentTime = HAL_GetTick();
+
+  // Format: WDG:R=reason,T=task,A=age,TO=timeout;deadline,age,maxGap;...
+  length = sprintf(txBuffer, "WDG:R=%d,T=%d,A=%u,TO=%u",
+                   status->resetReason,
+                   status->missedTask,
+                   status->missedAge,
+                   WATCHDOG_TIMEOUT);
+
+  for (uint8_t task = 0; task < WATCHDOG_TASK_COUNT; task++) {
+    length += sprintf(txBuffer + length, ";%lu,%lu,%lu",
+                      (unsigned long)WATCHDOG_GetDeadline(task),
+                      (unsigned long)(currentTime - status->lastCheckin[task]),
+                      (unsigned long)status->maxGap[task]);
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send the saved crash report over USB
+  * @param  report: Pointer to the report, NULL if there is none
+  * @retval None
+  */
+void USB_SendCrashReport(const CrashReport_t* report)
+{
+  int length = 0;
+
+  if (report == NULL) {
+    length = sprintf(txBuffer, "CRASH:N=0\r\n");
+    CDC_Transmit_FS((uint8_t*)txBuffer, length);
+    return;
+  }
+
+  // Format: CRASH:N=count,S=source,V=frameValid,T=tick,PC=..,LR=..,PSR=..,CFSR=..,HFSR=..,BFAR=..,MMFAR=..,SP=..,R=r0,r1,r2,r3,r12;STK=w0,w1,...
+  length = sprintf(txBuffer, "CRASH:N=%lu,S=%d,V=%d,T=%lu,PC=%08lX,LR=%08lX,PSR=%08lX,"
+                   "CFSR=%08lX,HFSR=%08lX,BFAR=%08lX,MMFAR=%08lX,SP=%08lX,R=%lX,%lX,%lX,%lX,%lX;STK=",
+                   (unsigned long)report->count,
+                   report->source,
+                   report->frameValid,
+                   (unsigned long)report->tick,
+                   (unsigned long)report->pc,
+                   (unsigned long)report->lr,
+                   (unsigned long)report->xpsr,
+                   (unsigned long)report->cfsr,
+                   (unsigned long)report->hfsr,
+                   (unsigned long)report->bfar,
+                   (unsigned long)report->mmfar,
+                   (unsigned long)report->sp,
+                   (unsigned long)report->r0,
+                   (unsigned long)report->r1,
+                   (unsigned long)report->r2,
+                   (unsigned long)report->r3,
+                   (unsigned long)report->r12);
+
+  for (uint8_t i = 0; i < CRASH_STACK_WORDS; i++) {
+    length += sprintf(txBuffer + length, i ? ",%lX" : "%lX", (unsigned long)report->stack[i]);
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send the last emergency record over USB
+  * @param  record: Pointer to the record, NULL if there is none
+  * @param  freeSlots: Emergency slots left
+  * @retval None
+  */
+void USB_SendSupplyRecord(const SupplyRecord_t* record, uint16_t freeSlots)
+{
+  int length = 0;
+
+  if (record == NULL) {
+    length = sprintf(txBuffer, "PVD:N=0,FREE=%u\r\n", freeSlots);
+    CDC_Transmit_FS((uint8_t*)txBuffer, length);
+    return;
+  }
+
+  // Format: PVD:N=seq,FREE=slots,TU=saveUs,S=secs,T=tick,F=faults,LF=lastFault,LK=locked,ST=state,V=mvA,mvB,mvC,mvL
+  length = sprintf(txBuffer, "PVD:N=%lu,FREE=%u,TU=%u,S=%lu,T=%lu,F=%d,LF=%d,LK=%d,ST=%d,V=%u,%u,%u,%u\r\n",
+                   (unsigned long)record->sequence,
+                   freeSlots,
+                   record->saveTimeUs,
+                   (unsigned long)record->operatingSeconds,
+                   (unsigned long)record->tick,
+                   record->faults,
+                   record->lastFault,
+                   record->lockedLines,
+                   record->state,
+                   record->voltages[BANK_A],
+                   record->voltages[BANK_B],
+                   record->voltages[CHARGE],
+                   record->voltages[LOAD]);
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send relay actuation statistics over USB
+  * @param  stats: Pointer to the statistics
+  * @retval None
+  */
+void USB_SendLatchRelayStats(const LatchStats_t* stats)
+{
+  int length = 0;
+
+  // Format: RLY:P=position,X=expected,R=lastResult,N=actuations,RT=retries,FL=failures,SP=spontaneous,AB=aborted,DR=dropped,B=busy,T=lastUs,TM=maxUs
+  length = sprintf(txBuffer, "RLY:P=%d,X=%d,R=%d,N=%lu,RT=%lu,FL=%lu,SP=%lu,AB=%lu,DR=%lu,B=%d,T=%lu,TM=%lu\r\n",
+                   stats->position,
+                   stats->expected,
+                   stats->lastResult,
+                   (unsigned long)stats->actuations,
+                   (unsigned long)stats->retries,
+                   (unsigned long)stats->failures,
+                   (unsigned long)stats->spontaneous,
+                   (unsigned long)stats->aborted,
+                   (unsigned long)stats->dropped,
+                   LATCH_IsBusy(),
+                   (unsigned long)stats->lastActuationUs,
+                   (unsigned long)stats->maxActuationUs);
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send output self-check counters over USB
+  * @param  stats: Pointer to the counters
+  * @retval None
+  */
+void USB_SendOutputCheckStats(const OutputCheckStats_t* stats)
+{
+  int length = 0;
+
+  // Format: OUT:N=checks,F=failed,RAISED=faults,LON=loadOn,LOFF=loadOff;odr,idr;... (SYSTEM_SetEnableSignal order)
+  length = sprintf(txBuffer, "OUT:N=%lu,F=%d,RAISED=%u,LON=%u,LOFF=%u",
+                   (unsigned long)stats->checks,
+                   stats->failed,
+                   stats->faultsRaised,
+                   stats->loadOnMismatches,
+                   stats->loadOffMismatches);
+
+  for (uint8_t i = 0; i < OUTCHECK_SIGNAL_COUNT; i++) {
+    length += sprintf(txBuffer + length, ";%u,%u",
+                      stats->odrMismatches[i],
+                      stats->idrMismatches[i]);
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send the fault snapshots as one binary frame
+  * @note   Frame: USB_BINARY_SYNC, 'Z', USB_FAULT_SNAPSHOT_VERSION, snapshot count,
+  *         FaultSnapshot_t entries oldest first, uint16 byte sum
+  * @param  snapshots: Pointer to the snapshots
+  * @retval None
+  */
+void USB_SendFaultSnapshots(const FaultSnapshots_t* snapshots)
+{
+  uint8_t* frame = (uint8_t*)txBuffer;
+  uint16_t length = 0;
+  uint16_t sum = 0;
+
+  frame[length++] = USB_BINARY_SYNC;
+  frame[length++] = 'Z';
+  frame[length++] = USB_FAULT_SNAPSHOT_VERSION;
+  frame[length++] = snapshots->count;
+
+  for (uint8_t i = 0; i < snapshots->count; i++) {
+    uint8_t slot = (snapshots->head + FAULT_SNAPSHOT_COUNT - snapshots->count + i) % FAULT_SNAPSHOT_COUNT;
+    memcpy(&frame[length], &snapshots->entries[slot], sizeof(FaultSnapshot_t));
+    length += sizeof(FaultSnapshot_t);
+  }
+
+  for (uint16_t i = 0; i < length; i++) {
+    sum += frame[i];
+  }
+  frame[length++] = (uint8_t)sum;
+  frame[length++] = (uint8_t)(sum >> 8);
+
+  // Send via USB
+  CDC_Transmit_FS(frame, length);
+}
+
+/**
+  * @brief  Send the protection rule table and rule states over USB
+  * @param  config: Pointer to the rule table
+  * @param  status: Pointer to the rule states
+  * @retval None
+  */
+void USB_SendProtectionStatus(const ProtectConfig_t* config, const ProtectStatus_t* status)
+{
+  const int size = sizeof(txBuffer) - 2; // Room kept for the line end
+  int length = 0;
+
+  // Format: PROT:N=rules,A=active,ACT=actions,DEF=defaults,T=trips,CYC=last,MAX=max;ch,dir,mV,hyst,q,r,act;...
+  length = snprintf(txBuffer, size, "PROT:N=%d,A=%u,ACT=%d,DEF=%d,T=%u,CYC=%lu,MAX=%lu",
+                    config->count,
+                    status->active,
+                    status->actions,
+                    status->fromDefaults,
+                    status->trips,
+                    (unsigned long)status->lastCycles,
+                    (unsigned long)status->maxCycles);
+  if (length >= size) {
+    length = size - 1;
+  }
+
+  // A full table at maximum field values exceeds the buffer: rules that
+  // do not fit are left out whole, N= still gives the count
+  for (uint8_t i = 0; i < config->count && length < size; i++) {
+    const ProtectRule_t* rule = &config->rules[i];
+    int field = snprintf(txBuffer + length, size - length, ";%d,%d,%u,%u,%u,%u,%d",
+                         rule->channel,
+                         rule->direction,
+                         rule->thresholdMv,
+                         rule->hysteresisMv,
+                         rule->qualifyMs,
+                         rule->releaseMs,
+                         rule->actions);
+    if (field < 0 || field >= size - length) {
+      break;
+    }
+    length += field;
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send the per-line fault history as one binary frame
+  * @note   Frame: USB_BINARY_SYNC, 'N', USB_FAULT_HISTORY_VERSION, line count,
+  *         uint32 operating seconds, FaultHistory_t, uint16 byte sum
+  * @param  history: Pointer to the history
+  * @retval None
+  */
+void USB_SendFaultHistory(const FaultHistory_t* history)
+{
+  uint8_t* frame = (uint8_t*)txBuffer;
+  uint32_t seconds = LIFETIME_GetOperatingSeconds();
+  uint16_t length = 0;
+  uint16_t sum = 0;
+
+  frame[length++] = USB_BINARY_SYNC;
+  frame[length++] = 'N';
+  frame[length++] = USB_FAULT_HISTORY_VERSION;
+  frame[length++] = FAULT_LINE_COUNT;
+  memcpy(&frame[length], &seconds, sizeof(seconds));
+  length += sizeof(seconds);
+  memcpy(&frame[length], history, sizeof(FaultHistory_t));
+  length += sizeof(FaultHistory_t);
+
+  for (uint16_t i = 0; i < length; i++) {
+    sum += frame[i];
+  }
+  frame[length++] = (uint8_t)sum;
+  frame[length++] = (uint8_t)(sum >> 8);
+
+  // Send via USB
+  CDC_Transmit_FS(frame, length);
+}
+
+/**
+  * @brief  Send scheduler task timing over USB
+  * @param  status: Pointer to the scheduler status
+  * @retval None
+  */
+void USB_SendSchedulerStatus(const SchedStatus_t* status)
+{
+  const int size = sizeof(txBuffer) - 2; // Room kept for the line end
+  int length = 0;
+
+  // Format: SCH:T=ticks,C=maxCatchUp,STK=stackPeak,TB=taskBytes;
+  //         level,period,phase,budget,runs,overruns,missed,lastUs,maxUs,maxLatencyUs,maxStack;...
+  length = snprintf(txBuffer, size, "SCH:T=%lu,C=%lu,STK=%u,TB=%u",
+                    (unsigned long)status->ticks,
+                    (unsigned long)status->maxCatchUp,
+                    status->stackPeak,
+                    status->taskBytes);
+  if (length >= size) {
+    length = size - 1;
+  }
+
+  // Tasks that do not fit at large counts are left out whole
+  for (uint8_t i = 0; i < status->taskCount && length < size; i++) {
+    const SchedTaskStats_t* task = &status->tasks[i];
+    int field = snprintf(txBuffer + length, size - length, ";%u,%u,%u,%u,%lu,%lu,%lu,%lu,%lu,%lu,%u",
+                         task->level,
+                         task->periodMs,
+                         task->phaseMs,
+                         task->budgetUs,
+                         (unsigned long)task->runs,
+                         (unsigned long)task->overruns,
+                         (unsigned long)task->missed,
+                         (unsigned long)task->lastUs,
+                         (unsigned long)task->maxUs,
+                         (unsigned long)task->maxLatencyUs,
+                         task->maxStack);
+    if (field < 0 || field >= size - length) {
+      break;
+    }
+    length += field;
+  }
+  length += sprintf(txBuffer + length, "\r\n");
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Send low-power residency and wake counts over USB
+  * @param  status: Pointer to the power manager status
+  * @retval None
+  */
+void USB_SendPowerStatus(const PowerStatus_t* status)
+{
+  int length = 0;
+
+  // Format: PWR:UP=ms,SL=ms,ST=ms,SLW=n,STW=n,ALW=n,RU=lastUs,RM=maxUs,RTC=counts/s,RDY=0-1,MODE=0-2
+  length = sprintf(txBuffer, "PWR:UP=%lu,SL=%lu,ST=%lu,SLW=%lu,STW=%lu,ALW=%lu,RU=%u,RM=%u,RTC=%u,RDY=%u,MODE=%u\r\n",
+                   (unsigned long)HAL_GetTick(),
+                   (unsigned long)status->sleepMs,
+                   (unsigned long)status->stopMs,
+                   (unsigned long)status->sleepWakes,
+                   (unsigned long)status->stopWakes,
+                   (unsigned long)status->alarmWakes,
+                   status->lastRestoreUs,
+                   status->maxRestoreUs,
+                   status->rtcPerSecond,
+                   status->stopReady,
+                   status->lastMode);
+
+  // Send via USB
+  CDC_Transmit_FS((uint8_t*)txBuffer, length);
+}
+
+/**
+  * @brief  Check whether a USB host has configured the device
+  * @retval 1 if configured
+  */
+uint8_t USB_IsConfigured(void)
+{
+  return hUsbDeviceFS.dev_state == USBD_STATE_CONFIGURED;
+}
+
 /**
   * @brief  Handle received USB data
   * @param  buffer: Pointer to received data
   * @param  length: Length of received data
   * @retval None
   */
-/*
 void USB_HandleRxData(uint8_t* buffer, uint32_t length)
 {
   // Call the main data received callback
   USB_DataReceived(buffer, length);
 }
-*/
+
 /**
   * @brief  CDC receive callback - called by USB CDC driver
   * @param  buffer: Pointer to received data
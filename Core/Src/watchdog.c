@@ -0,0 +1,190 @@
+/**
+  ******************************************************************************
+  * @file    watchdog.c
+  * @brief   Independent watchdog and task liveness module implementation
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "watchdog.h"
+#include "event_log.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* IWDG register access (no HAL IWDG driver in this project) */
+#define IWDG_KEY_RELOAD           0xAAAA
+#define IWDG_KEY_WRITE_ACCESS     0x5555
+#define IWDG_KEY_START            0xCCCC
+#define IWDG_PRESCALER_DIV32      0x3    // 40 kHz / 32 = 1.25 kHz
+#define IWDG_RELOAD               (WATCHDOG_TIMEOUT * 40 / 32 - 1)
+
+/* Deadline of each task in ms, well inside the IWDG timeout and above the
+   longest Stop mode period (power_manager, 333 ms at the slowest LSI) */
+static const uint16_t taskDeadlines[WATCHDOG_TASK_COUNT] = {
+  [WATCHDOG_TASK_ACQUISITION] = 400,
+  [WATCHDOG_TASK_PROTECTION]  = 400,
+  [WATCHDOG_TASK_COMMS]       = 500,
+  [WATCHDOG_TASK_BATTERY]     = 500,
+};
+
+/* Private variables ---------------------------------------------------------*/
+static WatchdogStatus_t status;
+static volatile uint8_t armed = 0;
+static volatile uint8_t missed = 0;  // Set from SysTick, stops refreshing
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t ReadResetReason(void);
+
+/**
+  * @brief  Report the last reset and start the IWDG
+  * @note   EVENT_Init must have been called; the IWDG cannot be stopped again
+  * @retval None
+  */
+void WATCHDOG_Init(void)
+{
+  status.resetReason = ReadResetReason();
+  status.missedTask = WATCHDOG_NO_TASK;
+  status.missedAge = 0;
+
+  // The backup domain keeps the missed task over any reset except power loss
+  __HAL_RCC_PWR_CLK_ENABLE();
+  __HAL_RCC_BKP_CLK_ENABLE();
+  HAL_PWR_EnableBkUpAccess();
+
+  if (BKP->WATCHDOG_BKP_TAG == WATCHDOG_BKP_MAGIC && BKP->WATCHDOG_BKP_TASK < WATCHDOG_TASK_COUNT) {
+    status.missedTask = (uint8_t)BKP->WATCHDOG_BKP_TASK;
+    status.missedAge = (uint16_t)BKP->WATCHDOG_BKP_AGE;
+  }
+  BKP->WATCHDOG_BKP_TAG = 0;
+
+  EVENT_Post(EVENT_RESET, status.resetReason, status.missedTask);
+
+  uint32_t currentTime = HAL_GetTick();
+  for (uint8_t task = 0; task < WATCHDOG_TASK_COUNT; task++) {
+    status.lastCheckin[task] = currentTime;
+    status.maxGap[task] = 0;
+  }
+  missed = 0;
+
+  // Keep the IWDG still while the core is halted by the debugger
+  __HAL_DBGMCU_FREEZE_IWDG();
+
+  IWDG->KR = IWDG_KEY_START;
+  IWDG->KR = IWDG_KEY_WRITE_ACCESS;
+  IWDG->PR = IWDG_PRESCALER_DIV32;
+  IWDG->RLR = IWDG_RELOAD;
+  while (IWDG->SR != 0) {
+  }
+  IWDG->KR = IWDG_KEY_RELOAD;
+
+  armed = 1;
+}
+
+/**
+  * @brief  Refresh the IWDG if no task has missed its deadline
+  * @note   Called once per main loop pass
+  * @retval None
+  */
+void WATCHDOG_Update(void)
+{
+  if (armed && !missed) {
+    IWDG->KR = IWDG_KEY_RELOAD;
+  }
+}
+
+/**
+  * @brief  Mark a task as alive
+  * @param  task: Task checking in (WatchdogTaskEnum)
+  * @retval None
+  */
+void WATCHDOG_Checkin(uint8_t task)
+{
+  if (task >= WATCHDOG_TASK_COUNT) {
+    return;
+  }
+
+  uint32_t currentTime = HAL_GetTick();
+  uint32_t gap = currentTime - status.lastCheckin[task];
+
+  if (gap > status.maxGap[task]) {
+    status.maxGap[task] = gap;
+  }
+  status.lastCheckin[task] = currentTime;
+}
+
+/**
+  * @brief  Check task deadlines and record the first miss
+  * @note   Called from the SysTick handler every 1 ms
+  * @retval None
+  */
+void WATCHDOG_TickFromISR(void)
+{
+  if (!armed || missed) {
+    return;
+  }
+
+  uint32_t currentTime = HAL_GetTick();
+
+  for (uint8_t task = 0; task < WATCHDOG_TASK_COUNT; task++) {
+    uint32_t age = currentTime - status.lastCheckin[task];
+
+    if (age > taskDeadlines[task]) {
+      BKP->WATCHDOG_BKP_TASK = task;
+      BKP->WATCHDOG_BKP_AGE = age > 0xFFFF ? 0xFFFF : age;
+      BKP->WATCHDOG_BKP_TAG = WATCHDOG_BKP_MAGIC;
+      missed = 1;
+      return;
+    }
+  }
+}
+
+/**
+  * @brief  Get the reset report and task liveness
+  * @retval Pointer to the status
+  */
+const WatchdogStatus_t* WATCHDOG_GetStatus(void)
+{
+  return &status;
+}
+
+/**
+  * @brief  Get the deadline of a task
+  * @param  task: Task (WatchdogTaskEnum)
+  * @retval Deadline in ms
+  */
+uint32_t WATCHDOG_GetDeadline(uint8_t task)
+{
+  return task < WATCHDOG_TASK_COUNT ? taskDeadlines[task] : 0;
+}
+
+/**
+  * @brief  Decode and clear the reset flags
+  * @retval Cause of the last reset (WatchdogResetEnum)
+  */
+static uint8_t ReadResetReason(void)
+{
+  uint8_t reason = WATCHDOG_RESET_UNKNOWN;
+
+  // The pin flag is also set by every internal reset, so it is checked last
+  if (__HAL_RCC_GET_FLAG(RCC_FLAG_IWDGRST)) {
+    reason = WATCHDOG_RESET_IWDG;
+  } else if (__HAL_RCC_GET_FLAG(RCC_FLAG_WWDGRST)) {
+    reason = WATCHDOG_RESET_WWDG;
+  } else if (__HAL_RCC_GET_FLAG(RCC_FLAG_SFTRST)) {
+    reason = WATCHDOG_RESET_SOFTWARE;
+  } else if (__HAL_RCC_GET_FLAG(RCC_FLAG_LPWRRST)) {
+    reason = WATCHDOG_RESET_LOW_POWER;
+  } else if (__HAL_RCC_GET_FLAG(RCC_FLAG_PORRST)) {
+    reason = WATCHDOG_RESET_POWER_ON;
+  } else if (__HAL_RCC_GET_FLAG(RCC_FLAG_PINRST)) {
+    reason = WATCHDOG_RESET_PIN;
+  }
+
+  __HAL_RCC_CLEAR_RESET_FLAGS();
+  return reason;
+}
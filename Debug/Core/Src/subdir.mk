@@ -7,47 +7,95 @@
 C_SRCS += \
 ../Core/Src/adc.c \
 ../Core/Src/battery_management.c \
+../Core/Src/charge_control.c \
+../Core/Src/crash_report.c \
+../Core/Src/equalize.c \
+../Core/Src/event_log.c \
 ../Core/Src/fault_handling.c \
 ../Core/Src/gpio.c \
+../Core/Src/latch_relay.c \
+../Core/Src/lifetime_stats.c \
 ../Core/Src/main.c \
+../Core/Src/nvm_storage.c \
+../Core/Src/output_check.c \
+../Core/Src/power_manager.c \
+../Core/Src/protection.c \
+../Core/Src/scheduler.c \
+../Core/Src/standby_monitor.c \
+../Core/Src/state_machine.c \
 ../Core/Src/stm32f1xx_hal_msp.c \
 ../Core/Src/stm32f1xx_it.c \
+../Core/Src/supply_monitor.c \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
 ../Core/Src/system_control.c \
 ../Core/Src/system_stm32f1xx.c \
 ../Core/Src/tim.c \
-../Core/Src/usb_com.c 
+../Core/Src/timebase.c \
+../Core/Src/usb_com.c \
+../Core/Src/watchdog.c 
 
 OBJS += \
 ./Core/Src/adc.o \
 ./Core/Src/battery_management.o \
+./Core/Src/charge_control.o \
+./Core/Src/crash_report.o \
+./Core/Src/equalize.o \
+./Core/Src/event_log.o \
 ./Core/Src/fault_handling.o \
 ./Core/Src/gpio.o \
+./Core/Src/latch_relay.o \
+./Core/Src/lifetime_stats.o \
 ./Core/Src/main.o \
+./Core/Src/nvm_storage.o \
+./Core/Src/output_check.o \
+./Core/Src/power_manager.o \
+./Core/Src/protection.o \
+./Core/Src/scheduler.o \
+./Core/Src/standby_monitor.o \
+./Core/Src/state_machine.o \
 ./Core/Src/stm32f1xx_hal_msp.o \
 ./Core/Src/stm32f1xx_it.o \
+./Core/Src/supply_monitor.o \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
 ./Core/Src/system_control.o \
 ./Core/Src/system_stm32f1xx.o \
 ./Core/Src/tim.o \
-./Core/Src/usb_com.o 
+./Core/Src/timebase.o \
+./Core/Src/usb_com.o \
+./Core/Src/watchdog.o 
 
 C_DEPS += \
 ./Core/Src/adc.d \
 ./Core/Src/battery_management.d \
+./Core/Src/charge_control.d \
+./Core/Src/crash_report.d \
+./Core/Src/equalize.d \
+./Core/Src/event_log.d \
 ./Core/Src/fault_handling.d \
 ./Core/Src/gpio.d \
+./Core/Src/latch_relay.d \
+./Core/Src/lifetime_stats.d \
 ./Core/Src/main.d \
+./Core/Src/nvm_storage.d \
+./Core/Src/output_check.d \
+./Core/Src/power_manager.d \
+./Core/Src/protection.d \
+./Core/Src/scheduler.d \
+./Core/Src/standby_monitor.d \
+./Core/Src/state_machine.d \
 ./Core/Src/stm32f1xx_hal_msp.d \
 ./Core/Src/stm32f1xx_it.d \
+./Core/Src/supply_monitor.d \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
 ./Core/Src/system_control.d \
 ./Core/Src/system_stm32f1xx.d \
 ./Core/Src/tim.d \
-./Core/Src/usb_com.d 
+./Core/Src/timebase.d \
+./Core/Src/usb_com.d \
+./Core/Src/watchdog.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -57,7 +105,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/adc.cyclo ./Core/Src/adc.d ./Core/Src/adc.o ./Core/Src/adc.su ./Core/Src/battery_management.cyclo ./Core/Src/battery_management.d ./Core/Src/battery_management.o ./Core/Src/battery_management.su ./Core/Src/fault_handling.cyclo ./Core/Src/fault_handling.d ./Core/Src/fault_handling.o ./Core/Src/fault_handling.su ./Core/Src/gpio.cyclo ./Core/Src/gpio.d ./Core/Src/gpio.o ./Core/Src/gpio.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/stm32f1xx_hal_msp.cyclo ./Core/Src/stm32f1xx_hal_msp.d ./Core/Src/stm32f1xx_hal_msp.o ./Core/Src/stm32f1xx_hal_msp.su ./Core/Src/stm32f1xx_it.cyclo ./Core/Src/stm32f1xx_it.d ./Core/Src/stm32f1xx_it.o ./Core/Src/stm32f1xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_control.cyclo ./Core/Src/system_control.d ./Core/Src/system_control.o ./Core/Src/system_control.su ./Core/Src/system_stm32f1xx.cyclo ./Core/Src/system_stm32f1xx.d ./Core/Src/system_stm32f1xx.o ./Core/Src/system_stm32f1xx.su ./Core/Src/tim.cyclo ./Core/Src/tim.d ./Core/Src/tim.o ./Core/Src/tim.su ./Core/Src/usb_com.cyclo ./Core/Src/usb_com.d ./Core/Src/usb_com.o ./Core/Src/usb_com.su
+	-$(RM) ./Core/Src/adc.cyclo ./Core/Src/adc.d ./Core/Src/adc.o ./Core/Src/adc.su ./Core/Src/battery_management.cyclo ./Core/Src/battery_management.d ./Core/Src/battery_management.o ./Core/Src/battery_management.su ./Core/Src/charge_control.cyclo ./Core/Src/charge_control.d ./Core/Src/charge_control.o ./Core/Src/charge_control.su ./Core/Src/crash_report.cyclo ./Core/Src/crash_report.d ./Core/Src/crash_report.o ./Core/Src/crash_report.su ./Core/Src/equalize.cyclo ./Core/Src/equalize.d ./Core/Src/equalize.o ./Core/Src/equalize.su ./Core/Src/event_log.cyclo ./Core/Src/event_log.d ./Core/Src/event_log.o ./Core/Src/event_log.su ./Core/Src/fault_handling.cyclo ./Core/Src/fault_handling.d ./Core/Src/fault_handling.o ./Core/Src/fault_handling.su ./Core/Src/gpio.cyclo ./Core/Src/gpio.d ./Core/Src/gpio.o ./Core/Src/gpio.su ./Core/Src/latch_relay.cyclo ./Core/Src/latch_relay.d ./Core/Src/latch_relay.o ./Core/Src/latch_relay.su ./Core/Src/lifetime_stats.cyclo ./Core/Src/lifetime_stats.d ./Core/Src/lifetime_stats.o ./Core/Src/lifetime_stats.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/nvm_storage.cyclo ./Core/Src/nvm_storage.d ./Core/Src/nvm_storage.o ./Core/Src/nvm_storage.su ./Core/Src/output_check.cyclo ./Core/Src/output_check.d ./Core/Src/output_check.o ./Core/Src/output_check.su ./Core/Src/power_manager.cyclo ./Core/Src/power_manager.d ./Core/Src/power_manager.o ./Core/Src/power_manager.su ./Core/Src/protection.cyclo ./Core/Src/protection.d ./Core/Src/protection.o ./Core/Src/protection.su ./Core/Src/scheduler.cyclo ./Core/Src/scheduler.d ./Core/Src/scheduler.o ./Core/Src/scheduler.su ./Core/Src/standby_monitor.cyclo ./Core/Src/standby_monitor.d ./Core/Src/standby_monitor.o ./Core/Src/standby_monitor.su ./Core/Src/state_machine.cyclo ./Core/Src/state_machine.d ./Core/Src/state_machine.o ./Core/Src/state_machine.su ./Core/Src/stm32f1xx_hal_msp.cyclo ./Core/Src/stm32f1xx_hal_msp.d ./Core/Src/stm32f1xx_hal_msp.o ./Core/Src/stm32f1xx_hal_msp.su ./Core/Src/stm32f1xx_it.cyclo ./Core/Src/stm32f1xx_it.d ./Core/Src/stm32f1xx_it.o ./Core/Src/stm32f1xx_it.su ./Core/Src/supply_monitor.cyclo ./Core/Src/supply_monitor.d ./Core/Src/supply_monitor.o ./Core/Src/supply_monitor.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_control.cyclo ./Core/Src/system_control.d ./Core/Src/system_control.o ./Core/Src/system_control.su ./Core/Src/system_stm32f1xx.cyclo ./Core/Src/system_stm32f1xx.d ./Core/Src/system_stm32f1xx.o ./Core/Src/system_stm32f1xx.su ./Core/Src/tim.cyclo ./Core/Src/tim.d ./Core/Src/tim.o ./Core/Src/tim.su ./Core/Src/timebase.cyclo ./Core/Src/timebase.d ./Core/Src/timebase.o ./Core/Src/timebase.su ./Core/Src/usb_com.cyclo ./Core/Src/usb_com.d ./Core/Src/usb_com.o ./Core/Src/usb_com.su ./Core/Src/watchdog.cyclo ./Core/Src/watchdog.d ./Core/Src/watchdog.o ./Core/Src/watchdog.su
 
 .PHONY: clean-Core-2f-Src
 
@@ -0,0 +1,327 @@
+/**
+  ******************************************************************************
+  * @file    fault_handling_test.c
+  * @brief   Host test of the fault line qualifier
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Builds fault_handling.c against the HAL stand-in and drives the BLOCK_100A
+ * line the way the EXTI and SysTick handlers do. The line is run through its
+ * retry policy until it locks, then a LOW glitch shorter than
+ * FAULT_MIN_PULSE_US is applied: the line must stay locked, waiting for the
+ * commanded clear, and must not run the policy again and count a second
+ * lockout. Glitches on an idle and on a released line return there as before.
+ * Init and the SysTick pass must leave the caller's PRIMASK as they found it.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "fault_handling.h"
+#include "system_control.h"
+#include "event_log.h"
+#include "lifetime_stats.h"
+#include "nvm_storage.h"
+#include "latch_relay.h"
+#include "adc.h"
+#include "scheduler.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define LINE            1             // BLOCK_100A, index into the line table
+#define LINE_PIN        FLT_BLOCK_100A_Pin
+#define CYCLES_PER_MS   72000
+#define GLITCH_CYCLES   (CYCLES_PER_MS / 4)   // 250 us LOW
+#define PULSE_MS        5
+#define LOCK_WAIT_MS    40000         // Beyond the longest hold time of the line
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t failures = 0;
+static uint32_t checks = 0;
+static LatchStats_t latchStats;
+
+/* Vector table of the startup code, copied by FAULT_Init */
+const uint32_t g_pfnVectors[16 + USBWakeUp_IRQn + 1];
+
+/* Private function prototypes -----------------------------------------------*/
+static void Check(int condition, const char* what);
+static void Edge(uint8_t low);
+static void Run(uint32_t ms);
+static void Pulse(void);
+static uint8_t Blocked(void);
+static void TestGlitchWhileIdle(void);
+static void TestGlitchWhileReleased(void);
+static void TestGlitchWhileLocked(void);
+
+/**
+  * @brief  Run the cases and report the result
+  * @retval 0 if every check passed
+  */
+int main(void)
+{
+  // All lines HIGH (inactive) at startup
+  hostGpioA.IDR = FLT_FAST_CHARGE_Pin | FLT_CHARGE_Pin | FLT_BLOCK_100A_Pin;
+  hostGpioB.IDR = FLT_BLOCK_200A_Pin;
+
+  // Both run inside the caller's interrupt mask, which they must keep
+  hostPrimask = 1;
+  FAULT_Init();
+  Check(hostPrimask == 1, "PRIMASK kept by FAULT_Init");
+  FAULT_TickFromISR();
+  Check(hostPrimask == 1, "PRIMASK kept by FAULT_TickFromISR");
+  hostPrimask = 0;
+
+  TestGlitchWhileIdle();
+  TestGlitchWhileReleased();
+  TestGlitchWhileLocked();
+
+  printf("fault_handling_test: %lu checks: %s\n", (unsigned long)checks, failures ? "FAIL" : "PASS");
+  return failures ? 1 : 0;
+}
+
+/**
+  * @brief  A glitch on an idle line is counted and leaves it idle
+  * @retval None
+  */
+static void TestGlitchWhileIdle(void)
+{
+  const FaultLineStats_t* stats = &FAULT_GetLineStats()[LINE];
+
+  Edge(1);
+  hostDwt.CYCCNT += GLITCH_CYCLES;
+  Edge(0);
+  Run(2);
+  Check(stats->glitches == 1, "idle glitch counted");
+  Check(stats->faults == 0, "idle glitch not qualified");
+  Check(!Blocked(), "idle glitch releases the outputs");
+  Check(!(FAULT_GetState() & FAULT_BLOCK_100A), "no fault from an idle glitch");
+}
+
+/**
+  * @brief  A glitch during the hold time keeps the line released
+  * @retval None
+  */
+static void TestGlitchWhileReleased(void)
+{
+  const FaultLineStats_t* stats = &FAULT_GetLineStats()[LINE];
+
+  Pulse();
+  Check(FAULT_GetState() & FAULT_BLOCK_100A, "pulse latches the fault");
+
+  Edge(1);
+  hostDwt.CYCCNT += GLITCH_CYCLES;
+  Edge(0);
+  Run(2);
+  Check(stats->glitches == 2, "released glitch counted");
+  Check(Blocked(), "released line still holds the outputs off");
+  Check(FAULT_GetState() & FAULT_BLOCK_100A, "fault kept through the glitch");
+
+  // The hold time still ends in the automatic clear
+  Run(LOCK_WAIT_MS);
+  Check(!(FAULT_GetState() & FAULT_BLOCK_100A), "retry clears the fault");
+  Check(stats->retries == 1, "one retry");
+}
+
+/**
+  * @brief  A glitch on a locked line neither releases nor relocks it
+  * @retval None
+  */
+static void TestGlitchWhileLocked(void)
+{
+  const FaultLineStats_t* stats = &FAULT_GetLineStats()[LINE];
+
+  // Pulses until the retry limit of the line is used up
+  while (!(FAULT_GetLockedLines() & FAULT_BLOCK_100A)) {
+    Pulse();
+    Run(LOCK_WAIT_MS);
+  }
+  Check(stats->lockouts == 1, "line locked once");
+
+  uint32_t glitches = stats->glitches;
+  Edge(1);
+  hostDwt.CYCCNT += GLITCH_CYCLES;
+  Edge(0);
+  Run(2);
+  Check(stats->glitches == glitches + 1, "locked glitch counted");
+  Check(FAULT_GetLockedLines() & FAULT_BLOCK_100A, "line stays locked after the glitch");
+
+  Run(LOCK_WAIT_MS);
+  Check(stats->lockouts == 1, "glitch does not lock the line again");
+  Check(FAULT_GetLockedLines() & FAULT_BLOCK_100A, "line still waits for the clear");
+  Check(Blocked(), "locked line holds the outputs off");
+  Check(FAULT_GetState() & FAULT_BLOCK_100A, "fault still latched");
+
+  // Only the commanded clear releases it
+  FAULT_ClearLatched(FAULT_BLOCK_100A);
+  Run(2);
+  Check(!(FAULT_GetLockedLines() & FAULT_BLOCK_100A), "commanded clear unlocks");
+  Check(!Blocked(), "outputs released by the clear");
+  Check(!(FAULT_GetState() & FAULT_BLOCK_100A), "fault cleared");
+}
+
+/**
+  * @brief  Drive the line and run the EXTI handler path
+  * @param  low: 1 to assert (LOW), 0 to release (HIGH)
+  * @retval None
+  */
+static void Edge(uint8_t low)
+{
+  if (low) {
+    hostGpioA.IDR &= ~(uint32_t)LINE_PIN;
+  } else {
+    hostGpioA.IDR |= LINE_PIN;
+  }
+  hostExti.PR = LINE_PIN;
+  FAULT_CutoffFromISR(hostDwt.CYCCNT);
+  FAULT_EdgeFromISR(LINE_PIN);
+  hostExti.PR = 0;
+}
+
+/**
+  * @brief  Run SysTick and the preempting level for a number of ms
+  * @param  ms: Time to run
+  * @retval None
+  */
+static void Run(uint32_t ms)
+{
+  for (uint32_t i = 0; i < ms; i++) {
+    uwTick++;
+    hostDwt.CYCCNT += CYCLES_PER_MS;
+    FAULT_TickFromISR();
+    FAULT_Check();
+  }
+}
+
+/**
+  * @brief  One qualified LOW pulse, ending released
+  * @retval None
+  */
+static void Pulse(void)
+{
+  Edge(1);
+  Run(PULSE_MS);
+  Edge(0);
+  Run(2);
+}
+
+/**
+  * @brief  Check whether the line holds its enables off
+  * @retval 1 if the 100 A block enable is blocked
+  */
+static uint8_t Blocked(void)
+{
+  return (FAULT_GetBlockedOutputs(GPIOA) & EN_BLOCK_100A_Pin) ? 1 : 0;
+}
+
+/**
+  * @brief  Count and report a failed check
+  * @param  condition: Check result
+  * @param  what: Description of the check
+  * @retval None
+  */
+static void Check(int condition, const char* what)
+{
+  checks++;
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/* Fakes of the modules fault_handling calls ---------------------------------*/
+Timestamp_t TIMEBASE_Now(void)
+{
+  return hostDwt.CYCCNT;
+}
+
+Timestamp_t TIMEBASE_FromCycles(uint32_t cycles)
+{
+  return cycles;
+}
+
+uint64_t TIMEBASE_ToMicros(Timestamp_t timestamp)
+{
+  return timestamp / (CYCLES_PER_MS / 1000);
+}
+
+void EVENT_Post(uint8_t type, uint8_t source, uint16_t data)
+{
+  (void)type;
+  (void)source;
+  (void)data;
+}
+
+uint8_t EVENT_GetCount(void)
+{
+  return 0;
+}
+
+uint8_t EVENT_Get(uint8_t index, Event_t* event)
+{
+  (void)index;
+  (void)event;
+  return 0;
+}
+
+uint32_t LIFETIME_GetOperatingSeconds(void)
+{
+  return uwTick / 1000;
+}
+
+uint8_t NVM_Read(uint8_t tag, void* data, uint16_t length)
+{
+  (void)tag;
+  (void)data;
+  (void)length;
+  return 0;
+}
+
+uint8_t NVM_Write(uint8_t tag, const void* data, uint16_t length)
+{
+  (void)tag;
+  (void)data;
+  (void)length;
+  return 1;
+}
+
+const LatchStats_t* LATCH_GetStats(void)
+{
+  return &latchStats;
+}
+
+uint8_t ADC_CopyRecent(uint16_t (*frames)[VOLTAGE_COUNT], uint8_t count)
+{
+  (void)frames;
+  (void)count;
+  return 0;
+}
+
+uint8_t SYSTEM_GetChargeMode(void)
+{
+  return CHARGE_OFF;
+}
+
+uint8_t SYSTEM_GetChargeInhibit(void)
+{
+  return 0;
+}
+
+uint8_t SYSTEM_IsPowerOutputOn(void)
+{
+  return 0;
+}
+
+uint32_t SCHED_Lock(void)
+{
+  return 0;
+}
+
+void SCHED_Unlock(uint32_t key)
+{
+  (void)key;
+}
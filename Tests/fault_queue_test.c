@@ -0,0 +1,238 @@
+/**
+  ******************************************************************************
+  * @file    fault_queue_test.c
+  * @brief   Host test of the fault event queue
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Runs the producer (SysTick qualifier) and the consumer (FAULT_Check) of
+ * fault_queue.h against each other on the host. The simulated interrupt is
+ * taken between consumer steps and inside the barrier of the consumer, the
+ * point where an early tail release would let the producer overwrite the
+ * slot being read. The barrier also checks that the slot is complete before
+ * head is published and read before tail is released. The consumer rebuilds
+ * its fault state from the latched mask after an overflow, as FAULT_Check
+ * does, and must always end up equal to it.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+
+static void Barrier(void);
+#define FAULT_QUEUE_BARRIER() Barrier()
+#include "fault_queue.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define LINE_COUNT   4
+#define LINE_MASK    ((1 << LINE_COUNT) - 1)
+#define ROUNDS       200000
+#define MAX_BURST    40      // Events per simulated interrupt, above FAULT_QUEUE_SIZE
+
+/* Private variables ---------------------------------------------------------*/
+static FaultQueue_t queue;
+static uint32_t seed = 1;
+static uint32_t failures = 0;
+
+/* Producer side */
+static uint8_t latched = 0;         // Published level, like latchedLines
+static uint64_t produced = 0;       // Sequence of the next event, dropped ones included
+static const FaultEvent_t* pushing = NULL;
+static uint8_t pushHead = 0;
+static uint32_t pushBarriers = 0;
+
+/* Consumer side */
+static uint8_t state = 0;           // Rebuilt level, like faultState
+static uint64_t consumed = 0;       // Events taken
+static uint64_t lastSequence = 0;
+static FaultEvent_t* popping = NULL;
+static uint8_t popTail = 0;
+static uint32_t popBarriers = 0;
+static uint32_t interrupted = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t Random(uint32_t range);
+static void Check(int condition, const char* what);
+static void Interrupt(void);
+static void Consume(void);
+
+/**
+  * @brief  Run the interleaving and report the result
+  * @retval 0 if every check passed
+  */
+int main(void)
+{
+  FAULT_QueueInit(&queue);
+
+  for (uint32_t round = 0; round < ROUNDS; round++) {
+    if (Random(4) == 0) {
+      Interrupt();
+    }
+    Consume();
+  }
+
+  // Quiet end: everything produced is either consumed or counted as dropped
+  Consume();
+  Check(queue.head == queue.tail, "queue empty at the end");
+  Check(consumed + queue.stats.overflows == produced, "every event consumed or counted");
+  Check(queue.stats.pushed == consumed, "pushed count");
+  Check(queue.stats.overflows > 0, "overflow exercised");
+  Check(interrupted > 0, "interrupt inside the consumer barrier exercised");
+  Check(queue.stats.highWater == FAULT_QUEUE_SIZE - 1, "high water at capacity");
+
+  printf("fault_queue_test: %llu produced, %llu consumed, %lu dropped, %lu resyncs, "
+         "%lu push / %lu pop barriers, %lu nested interrupts: %s\n",
+         (unsigned long long)produced, (unsigned long long)consumed,
+         (unsigned long)queue.stats.overflows, (unsigned long)queue.stats.resyncs,
+         (unsigned long)pushBarriers, (unsigned long)popBarriers,
+         (unsigned long)interrupted, failures ? "FAIL" : "PASS");
+
+  return failures ? 1 : 0;
+}
+
+/**
+  * @brief  Check the ordering at a barrier and take an interrupt in the consumer
+  * @retval None
+  */
+static void Barrier(void)
+{
+  if (pushing != NULL) {
+    // The slot must be complete while head still hides it
+    pushBarriers++;
+    Check(queue.head == pushHead, "head not published before the barrier");
+    Check(queue.slots[pushHead].time == pushing->time &&
+          queue.slots[pushHead].fault == pushing->fault &&
+          queue.slots[pushHead].type == pushing->type &&
+          queue.slots[pushHead].widthUs == pushing->widthUs, "slot written before head");
+    return;
+  }
+
+  if (popping != NULL) {
+    // The slot must be read while tail still protects it
+    popBarriers++;
+    Check(queue.tail == popTail, "tail not released before the barrier");
+    Check(queue.slots[popTail].time == popping->time, "slot read before tail");
+
+    // The producer runs here; the slot must stay intact until tail moves
+    if (Random(64) == 0) {
+      FaultEvent_t copy = queue.slots[popTail];
+      FaultEvent_t* outer = popping;
+
+      popping = NULL;
+      interrupted++;
+      Interrupt();
+      popping = outer;
+      Check(queue.slots[popTail].time == copy.time, "slot kept until tail is released");
+    }
+  }
+}
+
+/**
+  * @brief  Simulated SysTick: a burst of line events, as the qualifier queues them
+  * @retval None
+  */
+static void Interrupt(void)
+{
+  uint32_t burst = 1 + Random(MAX_BURST);
+
+  for (uint32_t i = 0; i < burst; i++) {
+    FaultEvent_t event;
+    uint8_t bit = 1 << Random(LINE_COUNT);
+
+    // The level is published before the event, as latchedLines is
+    if (Random(3) == 0) {
+      event.type = FAULT_EVENT_RELEASE;
+    } else if (latched & bit) {
+      latched &= ~bit;
+      event.type = FAULT_EVENT_CLEAR;
+    } else {
+      latched |= bit;
+      event.type = FAULT_EVENT_ASSERT;
+    }
+    event.fault = bit;
+    event.widthUs = (uint32_t)produced * 3;
+    event.time = ++produced;
+
+    pushing = &event;
+    pushHead = queue.head;
+    FAULT_QueuePush(&queue, &event);
+    pushing = NULL;
+  }
+}
+
+/**
+  * @brief  Simulated FAULT_Check: drain, apply, resync after an overflow
+  * @retval None
+  */
+static void Consume(void)
+{
+  FaultEvent_t event;
+
+  for (;;) {
+    popTail = queue.tail;
+    popping = &event;
+    uint8_t taken = FAULT_QueuePop(&queue, &event);
+    popping = NULL;
+    if (!taken) {
+      break;
+    }
+
+    // In order, and intact: a gap is only allowed where events were dropped
+    Check(event.time > lastSequence, "events in order");
+    Check(event.widthUs == (uint32_t)(event.time - 1) * 3, "event intact");
+    lastSequence = event.time;
+    consumed++;
+
+    if (event.type == FAULT_EVENT_ASSERT) {
+      state |= event.fault;
+    } else if (event.type == FAULT_EVENT_CLEAR) {
+      state &= ~event.fault;
+    }
+
+    // The producer may also run between two pops, rarely enough to drain
+    if (Random(64) == 0) {
+      Interrupt();
+    }
+  }
+
+  if (FAULT_QueueOverflowed(&queue)) {
+    state = (state & ~LINE_MASK) | latched;
+  }
+
+  // Drained and resynced, nothing in between: the state must be the level
+  Check(state == latched, "state matches the latched level");
+}
+
+/**
+  * @brief  Deterministic pseudo-random number
+  * @param  range: Exclusive upper bound
+  * @retval Value in [0, range)
+  */
+static uint32_t Random(uint32_t range)
+{
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 16) % range;
+}
+
+/**
+  * @brief  Count and report a failed check, first occurrences only
+  * @param  condition: Check result
+  * @param  what: Description of the check
+  * @retval None
+  */
+static void Check(int condition, const char* what)
+{
+  if (!condition) {
+    if (failures < 10) {
+      printf("FAIL: %s\n", what);
+    }
+    failures++;
+  }
+}
@@ -0,0 +1,295 @@
+/**
+  ******************************************************************************
+  * @file    protection_test.c
+  * @brief   Host test of the protection evaluation bound
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Builds protection.c against the HAL stand-in with a full table of
+ * PROTECT_MAX_RULES rules, all armed with every action. The worst frame is
+ * the one in which every rule changes state at once; the cost of
+ * PROTECT_Update beyond its fixed compare loop is the calls it makes, so
+ * the test counts them per update: at most one event per rule, at most one
+ * change per inhibit source and one relay request, and none at all in a
+ * frame where no rule changes state. A random phase then checks that the
+ * same bound holds for any sequence of frames.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "protection.h"
+#include "system_control.h"
+#include "battery_management.h"
+#include "latch_relay.h"
+#include "nvm_storage.h"
+#include "event_log.h"
+#include "scheduler.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define ALL_RULES       ((1 << PROTECT_MAX_RULES) - 1)
+#define QUALIFY_MS      100
+#define RELEASE_MS      200
+#define RANDOM_FRAMES   200000
+
+/* Private types -------------------------------------------------------------*/
+typedef struct {
+  uint32_t events;          // EVENT_Post calls
+  uint32_t latches;         // LATCH_Request calls
+  uint32_t powerInhibits;   // SYSTEM_SetPowerInhibit calls
+  uint32_t chargeInhibits;  // SYSTEM_SetChargeInhibit calls
+} Calls_t;
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t failures = 0;
+static uint32_t checks = 0;
+static uint32_t seed = 1;
+static Calls_t calls;
+static Calls_t worst;
+
+/* Private function prototypes -----------------------------------------------*/
+static void Check(int condition, const char* what);
+static uint32_t Random(uint32_t range);
+static void Frame(float above, float below);
+static void Update(void);
+static void TestAllChange(void);
+static void TestRandom(void);
+
+/**
+  * @brief  Run the cases and report the result
+  * @retval 0 if every check passed
+  */
+int main(void)
+{
+  PROTECT_Init();
+  Check(PROTECT_GetConfig()->count == PROTECT_MAX_RULES, "full table loaded");
+  Check(!PROTECT_GetStatus()->fromDefaults, "stored table used");
+
+  TestAllChange();
+  TestRandom();
+
+  printf("protection_test: %lu checks, worst update %lu events, %lu relay, "
+         "%lu + %lu inhibit calls: %s\n", (unsigned long)checks,
+         (unsigned long)worst.events, (unsigned long)worst.latches,
+         (unsigned long)worst.powerInhibits, (unsigned long)worst.chargeInhibits,
+         failures ? "FAIL" : "PASS");
+  return failures ? 1 : 0;
+}
+
+/**
+  * @brief  Every rule trips and releases in the same frame
+  * @retval None
+  */
+static void TestAllChange(void)
+{
+  // Past every threshold: the timers start, nothing trips yet
+  Frame(14.0f, 11.0f);
+  Update();
+  Check(calls.events == 0 && PROTECT_GetStatus()->active == 0, "no trip before qualifyMs");
+
+  uwTick += QUALIFY_MS - 1;
+  Update();
+  Check(calls.events == 0, "no trip one ms early");
+
+  // The worst frame: all rules trip together
+  uwTick += 1;
+  Update();
+  Check(PROTECT_GetStatus()->active == ALL_RULES, "all rules tripped");
+  Check(calls.events == PROTECT_MAX_RULES, "one event per rule");
+  Check(calls.latches == 1, "one relay request for all trips");
+  Check(calls.powerInhibits == 1 && calls.chargeInhibits == 1, "each inhibit applied once");
+
+  // Held: the frame costs the compares only
+  uwTick += 1;
+  Update();
+  Check(calls.events == 0 && calls.latches == 0, "no calls while held");
+  Check(calls.powerInhibits == 0 && calls.chargeInhibits == 0, "no inhibit calls while held");
+
+  // Back within hysteresis: all rules release together
+  Frame(12.0f, 13.0f);
+  Update();
+  uwTick += RELEASE_MS;
+  Update();
+  Check(PROTECT_GetStatus()->active == 0, "all rules released");
+  Check(calls.events == PROTECT_MAX_RULES, "one event per release");
+  Check(calls.latches == 0, "no relay request on release");
+  Check(calls.powerInhibits == 1 && calls.chargeInhibits == 1, "each inhibit released once");
+  Check(PROTECT_GetStatus()->trips == PROTECT_MAX_RULES, "trips counted");
+}
+
+/**
+  * @brief  Random frames never exceed the bound of the worst frame
+  * @retval None
+  */
+static void TestRandom(void)
+{
+  for (uint32_t i = 0; i < RANDOM_FRAMES; i++) {
+    Frame(10.0f + Random(60) * 0.1f, 10.0f + Random(60) * 0.1f);
+    uwTick += Random(2 * RELEASE_MS);
+    Update();
+  }
+  Check(worst.events == PROTECT_MAX_RULES, "at most one event per rule");
+  Check(worst.latches == 1, "at most one relay request");
+  Check(worst.powerInhibits == 1 && worst.chargeInhibits == 1, "at most one call per inhibit");
+  Check((PROTECT_GetStatus()->active & ~ALL_RULES) == 0, "no rule beyond the table");
+}
+
+/**
+  * @brief  Set the sample frame
+  * @param  above: Volts on the channels of the PROTECT_ABOVE rules
+  * @param  below: Volts on the channels of the PROTECT_BELOW rules
+  * @retval None
+  */
+static void Frame(float above, float below)
+{
+  systemState.voltages[BANK_A] = above;
+  systemState.voltages[BANK_B] = above;
+  systemState.voltages[CHARGE] = below;
+  systemState.voltages[LOAD] = below;
+}
+
+/**
+  * @brief  Run one evaluation and check its calls against the bound
+  * @retval None
+  */
+static void Update(void)
+{
+  calls.events = 0;
+  calls.latches = 0;
+  calls.powerInhibits = 0;
+  calls.chargeInhibits = 0;
+
+  PROTECT_Update();
+
+  if (calls.events > worst.events) worst.events = calls.events;
+  if (calls.latches > worst.latches) worst.latches = calls.latches;
+  if (calls.powerInhibits > worst.powerInhibits) worst.powerInhibits = calls.powerInhibits;
+  if (calls.chargeInhibits > worst.chargeInhibits) worst.chargeInhibits = calls.chargeInhibits;
+
+  if (calls.events > PROTECT_MAX_RULES || calls.latches > 1 ||
+      calls.powerInhibits > 1 || calls.chargeInhibits > 1) {
+    Check(0, "update within the bound");
+  }
+}
+
+/**
+  * @brief  Deterministic pseudo-random number
+  * @param  range: Exclusive upper bound
+  * @retval Value in [0, range)
+  */
+static uint32_t Random(uint32_t range)
+{
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 16) % range;
+}
+
+/**
+  * @brief  Count and report a failed check, first occurrences only
+  * @param  condition: Check result
+  * @param  what: Description of the check
+  * @retval None
+  */
+static void Check(int condition, const char* what)
+{
+  checks++;
+  if (!condition) {
+    if (failures < 10) {
+      printf("FAIL: %s\n", what);
+    }
+    failures++;
+  }
+}
+
+/* Fakes of the modules protection calls -------------------------------------*/
+uint8_t NVM_Read(uint8_t tag, void* data, uint16_t length)
+{
+  ProtectConfig_t* table = (ProtectConfig_t*)data;
+
+  if (tag != NVM_TAG_PROTECT_RULES || length != sizeof(*table)) {
+    return 0;
+  }
+
+  // Three rules per channel, BANK_A and BANK_B above, CHARGE and LOAD below
+  table->count = PROTECT_MAX_RULES;
+  table->version = PROTECT_CONFIG_VERSION;
+  table->reserved = 0;
+  for (uint8_t i = 0; i < PROTECT_MAX_RULES; i++) {
+    ProtectRule_t* rule = &table->rules[i];
+    rule->channel = i % VOLTAGE_COUNT;
+    rule->direction = (rule->channel == BANK_A || rule->channel == BANK_B) ?
+                      PROTECT_ABOVE : PROTECT_BELOW;
+    rule->actions = PROTECT_ACTION_INHIBIT_CHARGE | PROTECT_ACTION_OPEN_OUTPUT |
+                    PROTECT_ACTION_RELAY_RESET | PROTECT_ACTION_ALARM;
+    rule->reserved = 0;
+    rule->thresholdMv = (rule->direction == PROTECT_ABOVE) ? 13000 + i * 10 : 12000 - i * 10;
+    rule->hysteresisMv = 300;
+    rule->qualifyMs = QUALIFY_MS;
+    rule->releaseMs = RELEASE_MS;
+  }
+  return 1;
+}
+
+uint8_t NVM_Write(uint8_t tag, const void* data, uint16_t length)
+{
+  (void)tag;
+  (void)data;
+  (void)length;
+  return 1;
+}
+
+void EVENT_Post(uint8_t type, uint8_t source, uint16_t data)
+{
+  (void)type;
+  (void)source;
+  (void)data;
+  calls.events++;
+}
+
+uint8_t LATCH_Request(uint8_t target)
+{
+  (void)target;
+  calls.latches++;
+  return 1;
+}
+
+void SYSTEM_SetPowerInhibit(uint8_t source, uint8_t active)
+{
+  (void)source;
+  (void)active;
+  calls.powerInhibits++;
+}
+
+void SYSTEM_SetChargeInhibit(uint8_t source, uint8_t active)
+{
+  (void)source;
+  (void)active;
+  calls.chargeInhibits++;
+}
+
+void SYSTEM_SetLED(uint8_t ledIndex, uint8_t state)
+{
+  (void)ledIndex;
+  (void)state;
+}
+
+uint8_t BATTERY_GetAlarm(uint8_t bank)
+{
+  (void)bank;
+  return 0;
+}
+
+uint32_t SCHED_Lock(void)
+{
+  return 0;
+}
+
+void SCHED_Unlock(uint32_t key)
+{
+  (void)key;
+}
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    hal_stub.c
+  * @brief   Host stand-in for the HAL and CMSIS parts the modules use
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+
+/* Exported variables --------------------------------------------------------*/
+GPIO_TypeDef hostGpioA;
+GPIO_TypeDef hostGpioB;
+DWT_Type hostDwt;
+EXTI_TypeDef hostExti;
+SCB_Type hostScb;
+CoreDebug_Type hostCoreDebug;
+uint32_t hostPrimask = 0;
+volatile uint32_t uwTick = 0;
+uint32_t SystemCoreClock = 72000000;
+SystemState_t systemState;
+
+/**
+  * @brief  Current tick, advanced by the test through uwTick
+  * @retval Tick in ms
+  */
+uint32_t HAL_GetTick(void)
+{
+  return uwTick;
+}
+
+/**
+  * @brief  Advance the tick instead of waiting
+  * @param  delay: ms
+  * @retval None
+  */
+void HAL_Delay(uint32_t delay)
+{
+  uwTick += delay;
+}
+
+/**
+  * @brief  Drive a pin, the level reads back on IDR as on an output
+  * @param  port: GPIO port
+  * @param  pin: Pin mask
+  * @param  state: GPIO_PIN_SET or GPIO_PIN_RESET
+  * @retval None
+  */
+void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state)
+{
+  if (state == GPIO_PIN_SET) {
+    port->ODR |= pin;
+    port->IDR |= pin;
+  } else {
+    port->ODR &= ~(uint32_t)pin;
+    port->IDR &= ~(uint32_t)pin;
+  }
+}
+
+/**
+  * @brief  Read a pin level
+  * @param  port: GPIO port
+  * @param  pin: Pin mask
+  * @retval Pin level
+  */
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* port, uint16_t pin)
+{
+  return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+/**
+  * @brief  Toggle a pin
+  * @param  port: GPIO port
+  * @param  pin: Pin mask
+  * @retval None
+  */
+void HAL_GPIO_TogglePin(GPIO_TypeDef* port, uint16_t pin)
+{
+  HAL_GPIO_WritePin(port, pin, (port->ODR & pin) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
@@ -0,0 +1,150 @@
+/**
+  ******************************************************************************
+  * @file    stm32f1xx_hal.h
+  * @brief   Host stand-in for the HAL and CMSIS parts the modules use
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F1xx_HAL_H
+#define __STM32F1xx_HAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Found before the real header through the include path of Tests/Makefile,
+ * so the firmware modules build unchanged on the host. Peripherals are plain
+ * structs in RAM (hal_stub.c): a test sets IDR or CYCCNT and reads back ODR.
+ * Interrupt masking only tracks PRIMASK, nothing preempts on the host.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  HAL_OK = 0,
+  HAL_ERROR,
+  HAL_BUSY,
+  HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef enum {
+  GPIO_PIN_RESET = 0,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef enum {
+  CAN1_SCE_IRQn = 22,
+  USBWakeUp_IRQn = 42
+} IRQn_Type;
+
+typedef struct {
+  volatile uint32_t CRL;
+  volatile uint32_t CRH;
+  volatile uint32_t IDR;
+  volatile uint32_t ODR;
+  volatile uint32_t BSRR;
+  volatile uint32_t BRR;
+  volatile uint32_t LCKR;
+} GPIO_TypeDef;
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+  volatile uint32_t IMR;
+  volatile uint32_t EMR;
+  volatile uint32_t RTSR;
+  volatile uint32_t FTSR;
+  volatile uint32_t SWIER;
+  volatile uint32_t PR;
+} EXTI_TypeDef;
+
+typedef struct {
+  volatile uint32_t VTOR;
+} SCB_Type;
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+  uint32_t State;
+} ADC_HandleTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define GPIO_PIN_0   ((uint16_t)0x0001)
+#define GPIO_PIN_1   ((uint16_t)0x0002)
+#define GPIO_PIN_2   ((uint16_t)0x0004)
+#define GPIO_PIN_3   ((uint16_t)0x0008)
+#define GPIO_PIN_4   ((uint16_t)0x0010)
+#define GPIO_PIN_5   ((uint16_t)0x0020)
+#define GPIO_PIN_6   ((uint16_t)0x0040)
+#define GPIO_PIN_7   ((uint16_t)0x0080)
+#define GPIO_PIN_8   ((uint16_t)0x0100)
+#define GPIO_PIN_9   ((uint16_t)0x0200)
+#define GPIO_PIN_10  ((uint16_t)0x0400)
+#define GPIO_PIN_11  ((uint16_t)0x0800)
+#define GPIO_PIN_12  ((uint16_t)0x1000)
+#define GPIO_PIN_13  ((uint16_t)0x2000)
+#define GPIO_PIN_14  ((uint16_t)0x4000)
+#define GPIO_PIN_15  ((uint16_t)0x8000)
+
+#define FLASH_PAGE_SIZE 0x400U
+
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk     (1UL << 0)
+
+#define __RAM_FUNC
+#define __weak __attribute__((weak))
+
+/* Exported variables --------------------------------------------------------*/
+extern GPIO_TypeDef hostGpioA;
+extern GPIO_TypeDef hostGpioB;
+extern DWT_Type hostDwt;
+extern EXTI_TypeDef hostExti;
+extern SCB_Type hostScb;
+extern CoreDebug_Type hostCoreDebug;
+extern uint32_t hostPrimask;
+extern volatile uint32_t uwTick;
+extern uint32_t SystemCoreClock;
+
+#define GPIOA (&hostGpioA)
+#define GPIOB (&hostGpioB)
+#define DWT   (&hostDwt)
+#define EXTI  (&hostExti)
+#define SCB   (&hostScb)
+#define CoreDebug (&hostCoreDebug)
+
+/* Exported macros -----------------------------------------------------------*/
+#define __disable_irq()      (hostPrimask = 1)
+#define __enable_irq()       (hostPrimask = 0)
+#define __get_PRIMASK()      (hostPrimask)
+#define __set_PRIMASK(value) (hostPrimask = (value))
+#define __DMB()              __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __DSB()              __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* Exported functions --------------------------------------------------------*/
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t delay);
+void HAL_GPIO_WritePin(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* port, uint16_t pin);
+void HAL_GPIO_TogglePin(GPIO_TypeDef* port, uint16_t pin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F1xx_HAL_H */
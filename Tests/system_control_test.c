@@ -0,0 +1,211 @@
+/**
+  ******************************************************************************
+  * @file    system_control_test.c
+  * @brief   Host test of the enable gating in system_control
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Builds system_control.c against the HAL stand-in and drives the enables
+ * the way the 'E' host command does. An active power inhibit (low-voltage
+ * disconnect, protection open) must keep the block enables off, an active
+ * charge inhibit the charge enables, whatever the host requests. A fault
+ * cutoff keeps holding a commanded enable off as before.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "system_control.h"
+#include "fault_handling.h"
+#include "latch_relay.h"
+#include "scheduler.h"
+
+/* Private constants ---------------------------------------------------------*/
+/* SYSTEM_SetEnableSignal index order */
+#define SIGNAL_FAST_CHARGE  0
+#define SIGNAL_CHARGE       1
+#define SIGNAL_BLOCK_100A   2
+#define SIGNAL_BLOCK_200A   3
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t failures = 0;
+static uint32_t checks = 0;
+static uint16_t blocked[2] = {0};   // Fault cutoff masks returned by the fake
+
+/* Private function prototypes -----------------------------------------------*/
+static void Check(int condition, const char* what);
+static uint8_t PinOn(GPIO_TypeDef* port, uint16_t pin);
+static void AllSignals(uint8_t state);
+static void TestDisconnect(void);
+static void TestProtectionAndCharge(void);
+static void TestFaultHold(void);
+
+/**
+  * @brief  Run the cases and report the result
+  * @retval 0 if every check passed
+  */
+int main(void)
+{
+  SYSTEM_Init();
+
+  TestDisconnect();
+  TestProtectionAndCharge();
+  TestFaultHold();
+
+  printf("system_control_test: %lu checks: %s\n", (unsigned long)checks, failures ? "FAIL" : "PASS");
+  return failures ? 1 : 0;
+}
+
+/**
+  * @brief  'E' can not close the blocks during a low-voltage disconnect
+  * @retval None
+  */
+static void TestDisconnect(void)
+{
+  // Without an inhibit the host command drives the blocks
+  SYSTEM_SetEnableSignal(SIGNAL_BLOCK_100A, 1);
+  SYSTEM_SetEnableSignal(SIGNAL_BLOCK_200A, 1);
+  Check(PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "E2 drives the 100 A block");
+  Check(PinOn(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin), "E3 drives the 200 A block");
+
+  // The disconnect opens them, the host can not close them again
+  SYSTEM_SetPowerInhibit(INHIBIT_LOW_VOLTAGE, 1);
+  Check(!PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "disconnect opens the 100 A block");
+  Check(!PinOn(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin), "disconnect opens the 200 A block");
+
+  SYSTEM_SetEnableSignal(SIGNAL_BLOCK_100A, 1);
+  SYSTEM_SetEnableSignal(SIGNAL_BLOCK_200A, 1);
+  Check(!PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "E2 ignored during the disconnect");
+  Check(!PinOn(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin), "E3 ignored during the disconnect");
+  Check(!(SYSTEM_GetCommandedOutputs(GPIOA) & EN_BLOCK_100A_Pin), "clamped request not commanded");
+  Check(!(SYSTEM_GetCommandedOutputs(GPIOB) & EN_BLOCK_200A_Pin), "clamped request not commanded");
+
+  // The periodic update must not bring them back either
+  SYSTEM_SetPowerOutput(1);
+  SYSTEM_Update();
+  Check(!PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "output stays open during the disconnect");
+
+  // The caller's interrupt mask is kept
+  hostPrimask = 1;
+  SYSTEM_SetEnableSignal(SIGNAL_BLOCK_100A, 1);
+  Check(hostPrimask == 1, "PRIMASK restored");
+  hostPrimask = 0;
+
+  // Release: the commanded output comes back through the update
+  SYSTEM_SetPowerInhibit(INHIBIT_LOW_VOLTAGE, 0);
+  Check(PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "reconnect closes the blocks");
+
+  SYSTEM_SetPowerOutput(0);
+  SYSTEM_Update();
+  AllSignals(0);
+}
+
+/**
+  * @brief  Protection open and charge inhibit clamp their enables only
+  * @retval None
+  */
+static void TestProtectionAndCharge(void)
+{
+  SYSTEM_SetPowerInhibit(INHIBIT_PROTECTION, 1);
+  AllSignals(1);
+  Check(!PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "E2 ignored while protection is open");
+  Check(!PinOn(EN_BLOCK_200A_GPIO_Port, EN_BLOCK_200A_Pin), "E3 ignored while protection is open");
+  Check(PinOn(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin), "charge enable not affected by a power inhibit");
+  SYSTEM_SetPowerInhibit(INHIBIT_PROTECTION, 0);
+  AllSignals(0);
+
+  SYSTEM_SetChargeInhibit(INHIBIT_PROTECTION, 1);
+  AllSignals(1);
+  Check(!PinOn(EN_CHARGE_GPIO_Port, EN_CHARGE_Pin), "E1 ignored while charging is inhibited");
+  Check(!PinOn(EN_FAST_CHARGE_GPIO_Port, EN_FAST_CHARGE_Pin), "E0 ignored while charging is inhibited");
+  Check(PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "blocks not affected by a charge inhibit");
+  SYSTEM_SetChargeInhibit(INHIBIT_PROTECTION, 0);
+  AllSignals(0);
+}
+
+/**
+  * @brief  A fault cutoff holds a commanded enable off until it is released
+  * @retval None
+  */
+static void TestFaultHold(void)
+{
+  blocked[0] = EN_BLOCK_100A_Pin;
+  SYSTEM_SetEnableSignal(SIGNAL_BLOCK_100A, 1);
+  Check(!PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "fault holds the block off");
+  Check(SYSTEM_GetCommandedOutputs(GPIOA) & EN_BLOCK_100A_Pin, "held enable still commanded");
+
+  blocked[0] = 0;
+  SYSTEM_SetEnableSignal(SIGNAL_BLOCK_100A, 1);
+  Check(PinOn(EN_BLOCK_100A_GPIO_Port, EN_BLOCK_100A_Pin), "block back after the fault");
+  AllSignals(0);
+}
+
+/**
+  * @brief  Send the same request for every enable, as four 'E' commands
+  * @param  state: 0 for off, 1 for on
+  * @retval None
+  */
+static void AllSignals(uint8_t state)
+{
+  for (uint8_t signal = 0; signal < 4; signal++) {
+    SYSTEM_SetEnableSignal(signal, state);
+  }
+}
+
+/**
+  * @brief  Check a pin level
+  * @param  port: GPIO port
+  * @param  pin: Pin mask
+  * @retval 1 if driven high
+  */
+static uint8_t PinOn(GPIO_TypeDef* port, uint16_t pin)
+{
+  return (port->ODR & pin) ? 1 : 0;
+}
+
+/**
+  * @brief  Count and report a failed check
+  * @param  condition: Check result
+  * @param  what: Description of the check
+  * @retval None
+  */
+static void Check(int condition, const char* what)
+{
+  checks++;
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/* Fakes of the modules system_control calls ---------------------------------*/
+uint16_t FAULT_GetBlockedOutputs(GPIO_TypeDef* port)
+{
+  return blocked[port == GPIOB];
+}
+
+uint8_t LATCH_Request(uint8_t target)
+{
+  (void)target;
+  return 1;
+}
+
+void LATCH_Cancel(void)
+{
+}
+
+uint32_t SCHED_Lock(void)
+{
+  return 0;
+}
+
+void SCHED_Unlock(uint32_t key)
+{
+  (void)key;
+}
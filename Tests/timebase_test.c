@@ -0,0 +1,221 @@
+/**
+  ******************************************************************************
+  * @file    timebase_test.c
+  * @brief   Host test of the 64-bit timebase
+  ******************************************************************************
+  * @attention
+  *
+  * MicroVer ESS Controller - STM32F103C8T6 Firmware
+  * Created: 2025
+  *
+  ******************************************************************************
+  */
+
+/*
+ * Builds timebase.c against the HAL stand-in and replaces the weak
+ * TIMEBASE_ReadCycles with a 32-bit counter cut from a 64-bit reference
+ * time. Reads spaced by less than one wrap period must give back the
+ * reference exactly, across any number of wraps; a capture taken before a
+ * wrap must extend to its own period; and the microsecond conversion must
+ * follow the core clock the timebase was started with.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "timebase.h"
+
+/* Private constants ---------------------------------------------------------*/
+#define WRAP           ((Timestamp_t)1 << 32)
+#define RANDOM_STEPS   1000000
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t failures = 0;
+static uint32_t checks = 0;
+static uint32_t seed = 1;
+static Timestamp_t reference = 0;   // Time the counter is cut from
+static uint32_t reads = 0;          // TIMEBASE_ReadCycles calls
+
+/* Private function prototypes -----------------------------------------------*/
+static void Check(int condition, const char* what);
+static uint32_t Random(uint32_t range);
+static void Start(uint32_t clock);
+static void TestWrap(void);
+static void TestRandom(void);
+static void TestFromCycles(void);
+static void TestToMicros(void);
+
+/**
+  * @brief  Run the cases and report the result
+  * @retval 0 if every check passed
+  */
+int main(void)
+{
+  TestWrap();
+  TestRandom();
+  TestFromCycles();
+  TestToMicros();
+
+  printf("timebase_test: %lu checks, %lu counter reads: %s\n", (unsigned long)checks,
+         (unsigned long)reads, failures ? "FAIL" : "PASS");
+  return failures ? 1 : 0;
+}
+
+/**
+  * @brief  The high word counts every wrap of the counter
+  * @retval None
+  */
+static void TestWrap(void)
+{
+  Start(72000000);
+  Check(TIMEBASE_Now() == 0, "starts at 0");
+
+  reference = WRAP - 0x100;
+  Check(TIMEBASE_Now() == reference, "last period before the wrap");
+
+  reference = WRAP + 0x100;
+  Check(TIMEBASE_Now() == reference, "first wrap extended");
+  Check(TIMEBASE_Now() == reference, "no wrap without a counter step back");
+
+  // The SysTick read keeps the count at the slowest rate of the counter
+  for (uint32_t i = 0; i < 16; i++) {
+    reference += WRAP / 3;
+    TIMEBASE_TickFromISR();
+  }
+  Check(TIMEBASE_Now() == reference, "wraps counted by the tick read");
+
+  // A counter that lands exactly on 0 after a wrap
+  reference = (reference | (WRAP - 1)) + 1;
+  Check(TIMEBASE_Now() == reference, "wrap to exactly 0");
+
+  hostPrimask = 1;
+  TIMEBASE_Now();
+  Check(hostPrimask == 1, "PRIMASK restored");
+  hostPrimask = 0;
+}
+
+/**
+  * @brief  Random steps below one wrap period track the reference exactly
+  * @retval None
+  */
+static void TestRandom(void)
+{
+  Timestamp_t last;
+  uint32_t mismatches = 0;
+
+  Start(72000000);
+  last = TIMEBASE_Now();
+  for (uint32_t i = 0; i < RANDOM_STEPS; i++) {
+    // Up to just below one period, in two parts to reach the top bits
+    reference += ((Timestamp_t)Random(1 << 16) << 16) | Random(1 << 16);
+    Timestamp_t now = TIMEBASE_Now();
+    if (now != reference || now < last) {
+      mismatches++;
+    }
+    last = now;
+  }
+  Check(mismatches == 0, "random steps tracked");
+  Check(reference > 1000 * WRAP, "many wraps exercised");
+}
+
+/**
+  * @brief  A raw capture is extended to the period it was taken in
+  * @retval None
+  */
+static void TestFromCycles(void)
+{
+  Start(72000000);
+
+  // Walk up to the fifth wrap in steps the timebase can follow
+  while (reference + WRAP / 2 < 5 * WRAP - 0x40) {
+    reference += WRAP / 2;
+    TIMEBASE_Now();
+  }
+
+  // Captured just before the wrap, extended just after it
+  reference = 5 * WRAP - 0x40;
+  TIMEBASE_Now();
+  uint32_t capture = (uint32_t)reference;
+  reference += 0x80;
+  Check(TIMEBASE_FromCycles(capture) == 5 * WRAP - 0x40, "capture before the wrap");
+
+  // Captured in the current period
+  capture = (uint32_t)reference;
+  reference += 1000;
+  Check(TIMEBASE_FromCycles(capture) == reference - 1000, "capture in the same period");
+
+  // Captured almost one full period ago
+  capture = (uint32_t)reference;
+  reference += WRAP - 1;
+  Check(TIMEBASE_FromCycles(capture) == reference - (WRAP - 1), "capture one period old");
+
+  // The current time itself
+  Check(TIMEBASE_FromCycles((uint32_t)reference) == reference, "capture of now");
+}
+
+/**
+  * @brief  Conversion to microseconds at the clock of TIMEBASE_Init
+  * @retval None
+  */
+static void TestToMicros(void)
+{
+  Start(72000000);
+  Check(TIMEBASE_ToMicros(0) == 0, "0 cycles");
+  Check(TIMEBASE_ToMicros(71) == 0, "below 1 us truncates");
+  Check(TIMEBASE_ToMicros(72) == 1, "72 cycles at 72 MHz");
+  Check(TIMEBASE_ToMicros(WRAP) == WRAP / 72, "one wrap period");
+  Check(TIMEBASE_ToMicros((Timestamp_t)72000000 * 86400 * 365) == 1000000ULL * 86400 * 365,
+        "one year, beyond 32 bits of microseconds");
+
+  // Clock of the low-power mode
+  Start(8000000);
+  Check(TIMEBASE_ToMicros(8) == 1, "8 cycles at 8 MHz");
+  Check(TIMEBASE_ToMicros(3 * WRAP) == 3 * WRAP / 8, "three periods at 8 MHz");
+
+  SystemCoreClock = 72000000;
+}
+
+/**
+  * @brief  Restart the timebase at a core clock with the counter at 0
+  * @param  clock: SystemCoreClock in Hz
+  * @retval None
+  */
+static void Start(uint32_t clock)
+{
+  SystemCoreClock = clock;
+  reference = 0;
+  TIMEBASE_Init();
+  Check(hostDwt.CTRL & DWT_CTRL_CYCCNTENA_Msk, "counter started");
+}
+
+/**
+  * @brief  Deterministic pseudo-random number
+  * @param  range: Exclusive upper bound
+  * @retval Value in [0, range)
+  */
+static uint32_t Random(uint32_t range)
+{
+  seed = seed * 1103515245u + 12345u;
+  return (seed >> 16) % range;
+}
+
+/**
+  * @brief  Count and report a failed check
+  * @param  condition: Check result
+  * @param  what: Description of the check
+  * @retval None
+  */
+static void Check(int condition, const char* what)
+{
+  checks++;
+  if (!condition) {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+/* Counter the timebase reads instead of DWT->CYCCNT -------------------------*/
+uint32_t TIMEBASE_ReadCycles(void)
+{
+  reads++;
+  return (uint32_t)reference;
+}